@@ -0,0 +1,135 @@
+#ifndef ALGORITHMS_GRAPHS_CSR_GRAPH_H
+#define ALGORITHMS_GRAPHS_CSR_GRAPH_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Directed edge with a cost.
+struct edge {
+    const int from, to;
+    const double cost;
+};
+
+// Immutable directed graph in Compressed Sparse Row (CSR) format. All the adjacency lists are packed
+// back to back in two parallel arrays ('targets' and 'costs'), and the outgoing edges of a vertex v are
+// the ones at positions [offsets[v], offsets[v + 1]). Compared to a 'std::vector<std::vector<edge>>'
+// this uses three allocations instead of one per vertex, drops the redundant 'from' field of every
+// edge, and makes scanning an adjacency list a sequential walk over contiguous memory.
+class csr_graph {
+public:
+    // Outgoing edge of a vertex, as seen while iterating its adjacency list.
+    struct arc {
+        int to;
+        double cost;
+    };
+    class arc_iterator {
+    private:
+        const int *to;
+        const double *cost;
+    public:
+        arc_iterator(const int *to, const double *cost) : to(to), cost(cost) {}
+        arc operator*() const { return {*to, *cost}; }
+        arc_iterator &operator++() { ++to; ++cost; return *this; }
+        bool operator!=(const arc_iterator &other) const { return to != other.to; }
+    };
+    class adj_range {
+    private:
+        const arc_iterator first, last;
+    public:
+        adj_range(const arc_iterator &first, const arc_iterator &last) : first(first), last(last) {}
+        arc_iterator begin() const { return first; }
+        arc_iterator end() const { return last; }
+    };
+private:
+    // Arrays of a graph built in memory.
+    struct storage {
+        std::vector<int> offsets;
+        std::vector<int> targets;
+        std::vector<double> costs;
+    };
+    // Keeps alive the memory the arrays below point into: a 'storage', or the pages of a mapped file (see
+    // graph_file.h). The graph is immutable, so copies share it.
+    std::shared_ptr<const void> memory;
+    int vertices = 0;
+    std::size_t edges = 0;
+    const int *offsets = nullptr;
+    const int *targets = nullptr;
+    const double *costs = nullptr;
+
+    explicit csr_graph(std::shared_ptr<const storage> arrays)
+            : vertices(static_cast<int>(arrays->offsets.size()) - 1), edges(arrays->targets.size()),
+              offsets(arrays->offsets.data()), targets(arrays->targets.data()), costs(arrays->costs.data()) {
+        memory = std::move(arrays);
+    }
+    static std::shared_ptr<const storage> build(int vertices, const std::vector<edge> &edges) {
+        auto arrays = std::make_shared<storage>();
+        std::vector<int> &offsets = arrays->offsets, &targets = arrays->targets;
+        std::vector<double> &costs = arrays->costs;
+        offsets.assign(vertices + 1, 0);
+        targets.resize(edges.size());
+        costs.resize(edges.size());
+        // offsets[v + 1] counts the out-degree of v, so the prefix sums below leave in offsets[v]
+        // the position where the adjacency list of v starts.
+        for (const auto &e: edges) {
+            assert(0 <= e.from && e.from < vertices && 0 <= e.to && e.to < vertices);
+            ++offsets[e.from + 1];
+        }
+        for (int v = 0; v < vertices; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (const auto &e: edges) {
+            const int i = next[e.from]++;
+            targets[i] = e.to;
+            costs[i] = e.cost;
+        }
+        return arrays;
+    }
+public:
+    // Builds the graph from an edge list in O(V+E) with a counting sort on 'from'. Edges leaving the
+    // same vertex keep their relative order from 'edges'.
+    csr_graph(int vertices, const std::vector<edge> &edges) : csr_graph(build(vertices, edges)) {}
+    // Views arrays laid out as those of a built graph, which live in memory owned by 'memory' (e.g. a mapped
+    // file). Nothing is copied, so this takes O(1).
+    csr_graph(int vertices, std::size_t edges, const int *offsets, const int *targets, const double *costs,
+              std::shared_ptr<const void> memory)
+            : memory(std::move(memory)), vertices(vertices), edges(edges), offsets(offsets), targets(targets),
+              costs(costs) {}
+    // Returns the graph with the direction of every edge reversed in O(V+E). The adjacency list of a vertex
+    // in the reversed graph holds its incoming edges, which allows to search backwards from it.
+    csr_graph reversed() const {
+        auto arrays = std::make_shared<storage>();
+        std::vector<int> &result_offsets = arrays->offsets, &result_targets = arrays->targets;
+        std::vector<double> &result_costs = arrays->costs;
+        result_offsets.assign(vertices + 1, 0);
+        result_targets.resize(edges);
+        result_costs.resize(edges);
+        for (std::size_t i = 0; i < edges; ++i) {
+            ++result_offsets[targets[i] + 1];
+        }
+        for (int v = 0; v < vertices; ++v) {
+            result_offsets[v + 1] += result_offsets[v];
+        }
+        std::vector<int> next(result_offsets.begin(), result_offsets.end() - 1);
+        for (int v = 0; v < vertices; ++v) {
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                const int j = next[targets[i]]++;
+                result_targets[j] = v;
+                result_costs[j] = costs[i];
+            }
+        }
+        return csr_graph(std::move(arrays));
+    }
+    std::size_t size() const { return vertices; }
+    std::size_t edge_count() const { return edges; }
+    int degree(int vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+    adj_range adj_list(int vertex) const {
+        return {{targets + offsets[vertex], costs + offsets[vertex]},
+                {targets + offsets[vertex + 1], costs + offsets[vertex + 1]}};
+    }
+};
+
+#endif  // ALGORITHMS_GRAPHS_CSR_GRAPH_H
@@ -0,0 +1,331 @@
+#ifndef ALGORITHMS_GRAPHS_EDGE_LIST_PARSER_H
+#define ALGORITHMS_GRAPHS_EDGE_LIST_PARSER_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "thread_pool.h"
+
+// Streaming parser of the text formats graphs are usually distributed in:
+// - DIMACS shortest path (.gr): 'c' comment lines, a 'p sp V E' problem line, and 'a u v w' arc lines with
+//   vertices numbered from 1.
+// - SNAP edge lists: '#' comment lines and 'u v' lines with vertices numbered from 0. The number of vertices
+//   is the largest id plus one, and an optional third column is read as the weight (1 otherwise).
+// - Matrix Market coordinate matrices: a '%%MatrixMarket matrix coordinate <field> <symmetry>' banner, '%'
+//   comment lines, a 'rows columns entries' size line, and 'i j [value]' lines numbered from 1. Entry (i, j)
+//   is the edge i -> j. 'pattern' matrices have weight 1, and the upper triangle of 'symmetric' and
+//   'skew-symmetric' matrices is added as the reverse edges.
+// The file is read in large blocks without iostreams, and the numbers are parsed by hand. The complete lines
+// of a block can be split among the threads of a pool, each one filling its own part of the edge list, and
+// the parts are concatenated in order, so the edges always come in the order of the file. The result can be
+// used as an edge list (e.g. for Kruskal or Bellman-Ford) or handed to the 'csr_graph' constructor. Any
+// 'Edge' type that can be built as '{from, to, cost}' works, so each program keeps its own edge struct.
+enum class edge_list_format { dimacs, snap, matrix_market };
+
+template<typename Edge>
+struct parsed_edge_list {
+    const int vertices;
+    const std::vector<Edge> edges;
+};
+
+// Hand-rolled number parsing. These functions skip the blanks before a number and move 'p' past it, and
+// return false if there is no number there. The text always ends with a '\n', which stops every loop.
+inline void skip_blanks(const char *&p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') { ++p; }
+}
+
+// Non-negative integer, at most 'std::numeric_limits<int>::max()'.
+inline bool parse_index(const char *&p, long long &value) {
+    skip_blanks(p);
+    if (*p < '0' || *p > '9') { return false; }
+    long long result = 0;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        result = result * 10 + (*p - '0');
+        if (result > std::numeric_limits<int>::max()) { return false; }
+    }
+    value = result;
+    return true;
+}
+
+// Decimal number with optional sign, fraction and exponent. A number with up to 19 significant digits whose
+// mantissa fits in 53 bits and whose decimal exponent is in [-22, 22] is computed exactly with one
+// multiplication or division by an exact power of ten (Clinger's fast path), which covers the weights of
+// practically every graph file. Anything else falls back to 'strtod'.
+inline bool parse_number(const char *&p, double &value) {
+    static constexpr double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    skip_blanks(p);
+    const char *start = p;
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+') { ++p; }
+    std::uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any_digit = false;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        any_digit = true;
+        if (mantissa != 0 || *p != '0') { ++digits; }
+        if (digits <= 19) { mantissa = mantissa * 10 + (*p - '0'); }
+    }
+    if (*p == '.') {
+        for (++p; *p >= '0' && *p <= '9'; ++p) {
+            any_digit = true;
+            if (mantissa != 0 || *p != '0') { ++digits; }
+            if (digits <= 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (!any_digit) { return false; }
+    if (*p == 'e' || *p == 'E') {
+        const char *q = p + 1;
+        const bool negative_exponent = *q == '-';
+        if (*q == '-' || *q == '+') { ++q; }
+        if (*q < '0' || *q > '9') { return false; }
+        int e = 0;
+        for (; *q >= '0' && *q <= '9'; ++q) {
+            if (e < 100000) { e = e * 10 + (*q - '0'); }
+        }
+        exponent += negative_exponent ? -e : e;
+        p = q;
+    }
+    if (digits <= 19 && mantissa <= (std::uint64_t{1} << 53) && -22 <= exponent && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+    char *end = nullptr;
+    value = std::strtod(start, &end);
+    p = end;
+    return true;
+}
+
+template<typename Edge>
+class edge_list_parser {
+private:
+    static constexpr std::size_t BLOCK_SIZE = std::size_t{1} << 24;
+    // Blocks with fewer bytes of complete lines are parsed by a single thread.
+    static constexpr std::size_t PARALLEL_THRESHOLD = std::size_t{1} << 20;
+
+    const edge_list_format format;
+    // Set by the preamble (problem line, banner and size line), which is parsed before any edge.
+    bool in_preamble;
+    long long declared_vertices = -1, declared_edges = 0;
+    bool weighted = true, symmetric = false, skew = false;
+
+    // Edges (unless they go straight to the result) and largest vertex id (plus one) of a run of lines, or the
+    // first bad line found in it.
+    struct part {
+        std::vector<Edge> edges;
+        long long vertices = 0;
+        std::string error;
+    };
+
+    static const char *next_line(const char *p) {
+        while (*p != '\n') { ++p; }
+        return p + 1;
+    }
+    static bool at_line_end(const char *&p) {
+        skip_blanks(p);
+        return *p == '\n';
+    }
+    static std::string line_text(const char *line) {
+        return std::string(line, next_line(line) - 1);
+    }
+    [[noreturn]] static void fail(const std::string &message, const char *line) {
+        throw std::runtime_error("edge list: " + message + ": '" + line_text(line) + "'");
+    }
+
+    // Parses a line of the preamble, which ends with the problem line (DIMACS) or the size line (Matrix Market).
+    void parse_preamble_line(const char *line) {
+        const char *p = line;
+        skip_blanks(p);
+        if (format == edge_list_format::dimacs) {
+            if (*p == 'c' || *p == '\n') { return; }
+            if (*p != 'p') { fail("expected the problem line 'p sp V E'", line); }
+            for (++p; *p == ' ' || *p == '\t'; ++p) {}
+            while (*p != ' ' && *p != '\t' && *p != '\n') { ++p; }
+            if (!parse_index(p, declared_vertices) || !parse_index(p, declared_edges) || !at_line_end(p)) {
+                fail("bad problem line", line);
+            }
+            in_preamble = false;
+            return;
+        }
+        // Matrix Market. The banner is the first line, so no vertex count means that it is still missing.
+        if (*p == '%' && std::strncmp(p, "%%MatrixMarket", 14) == 0) {
+            std::string banner = line_text(p);
+            std::transform(banner.begin(), banner.end(), banner.begin(), [](char c) { return std::tolower(c); });
+            if (banner.find("coordinate") == std::string::npos) {
+                fail("only coordinate matrices are supported", line);
+            }
+            if (banner.find("complex") != std::string::npos) { fail("complex matrices are not supported", line); }
+            weighted = banner.find("pattern") == std::string::npos;
+            skew = banner.find("skew-symmetric") != std::string::npos;
+            symmetric = skew || banner.find("symmetric") != std::string::npos;
+            declared_vertices = 0;
+            return;
+        }
+        if (declared_vertices == -1) { fail("expected the '%%MatrixMarket' banner", line); }
+        if (*p == '%' || *p == '\n') { return; }
+        long long rows = 0, columns = 0, entries = 0;
+        if (!parse_index(p, rows) || !parse_index(p, columns) || !parse_index(p, entries) || !at_line_end(p)) {
+            fail("bad size line", line);
+        }
+        declared_vertices = std::max(rows, columns);
+        declared_edges = symmetric ? 2 * entries : entries;
+        in_preamble = false;
+    }
+
+    // Parses the edge lines in [begin, end), appending the edges to 'edges'.
+    void parse_lines(const char *begin, const char *end, std::vector<Edge> &edges, part &out) const {
+        const char comment = format == edge_list_format::dimacs ? 'c' : format == edge_list_format::snap ? '#' : '%';
+        const int base = format == edge_list_format::snap ? 0 : 1;
+        const long long limit = format == edge_list_format::snap ? std::numeric_limits<int>::max() - 1LL
+                                                                  : declared_vertices;
+        const char *line = begin;
+        while (line < end) {
+            const char *p = line;
+            skip_blanks(p);
+            if (*p == comment || *p == '\n') {
+                line = next_line(p);
+                continue;
+            }
+            if (format == edge_list_format::dimacs) {
+                if (*p != 'a') {
+                    out.error = "expected an arc line 'a u v w': '" + line_text(line) + "'";
+                    return;
+                }
+                ++p;
+            }
+            long long from = 0, to = 0;
+            double cost = 1;
+            bool ok = parse_index(p, from) && parse_index(p, to);
+            if (ok && format == edge_list_format::snap) {
+                ok = at_line_end(p) || (parse_number(p, cost) && at_line_end(p));
+            } else if (ok) {
+                ok = (!weighted || parse_number(p, cost)) && at_line_end(p);
+            }
+            from -= base;
+            to -= base;
+            if (!ok || from < 0 || to < 0 || from >= limit || to >= limit) {
+                out.error = "bad edge line: '" + line_text(line) + "'";
+                return;
+            }
+            edges.push_back({static_cast<int>(from), static_cast<int>(to), cost});
+            if (symmetric && from != to) {
+                edges.push_back({static_cast<int>(to), static_cast<int>(from), skew ? -cost : cost});
+            }
+            out.vertices = std::max(out.vertices, std::max(from, to) + 1);
+            // A parsed line always stops at its '\n'.
+            line = p + 1;
+        }
+    }
+
+public:
+    explicit edge_list_parser(edge_list_format format)
+            : format(format), in_preamble(format != edge_list_format::snap) {}
+
+    parsed_edge_list<Edge> parse(const std::string &path, thread_pool *pool) {
+        const std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+        if (!file) { throw std::runtime_error("edge list: can't open " + path); }
+        // Every edge line takes at least 4 bytes ('u v\n') and gives at most 2 edges, which bounds the number of
+        // edges a header may ask to reserve. 'file_size' is 0 if the file can't be measured.
+        std::size_t file_size = 0;
+        if (std::fseek(file.get(), 0, SEEK_END) == 0) {
+            const long end = std::ftell(file.get());
+            file_size = end > 0 ? static_cast<std::size_t>(end) : 0;
+        }
+        std::rewind(file.get());
+        const int threads = pool == nullptr ? 1 : pool->size();
+        std::vector<part> parts(threads);
+        std::vector<Edge> edges;
+        long long vertices = 0;
+        // 'buffer' holds the incomplete last line of the previous block followed by the new block.
+        std::vector<char> buffer;
+        std::size_t carry = 0;
+        bool done = false;
+        while (!done) {
+            buffer.resize(carry + BLOCK_SIZE + 1);
+            const std::size_t read = std::fread(buffer.data() + carry, 1, BLOCK_SIZE, file.get());
+            if (std::ferror(file.get())) { throw std::runtime_error("edge list: can't read " + path); }
+            std::size_t size = carry + read;
+            done = read < BLOCK_SIZE;
+            if (done && size > 0 && buffer[size - 1] != '\n') { buffer[size++] = '\n'; }
+            const char *begin = buffer.data();
+            const char *end = begin;
+            for (std::size_t i = size; i > 0; --i) {
+                if (buffer[i - 1] == '\n') {
+                    end = begin + i;
+                    break;
+                }
+            }
+            if (in_preamble) {
+                while (in_preamble && begin < end) {
+                    parse_preamble_line(begin);
+                    begin = next_line(begin);
+                }
+                // The header tells how many edges follow, so the result is only allocated once.
+                if (!in_preamble) {
+                    edges.reserve(std::min(static_cast<std::size_t>(declared_edges), file_size / 2));
+                }
+            }
+
+            // Split the complete lines into 'threads' runs of about the same size, cut after a '\n'.
+            const int chunks = static_cast<std::size_t>(end - begin) < PARALLEL_THRESHOLD ? 1 : threads;
+            std::vector<const char *> cuts(chunks + 1, end);
+            cuts[0] = begin;
+            for (int i = 1; i < chunks; ++i) {
+                const char *cut = std::max(cuts[i - 1], begin + (end - begin) * i / chunks);
+                cuts[i] = cut == begin || cut == end || cut[-1] == '\n' ? cut : next_line(cut);
+            }
+            // A single run is parsed straight into the result, saving a copy of every edge.
+            const auto parse_chunk = [&](int i) {
+                if (i < chunks) { parse_lines(cuts[i], cuts[i + 1], chunks == 1 ? edges : parts[i].edges, parts[i]); }
+            };
+            if (chunks == 1) { parse_chunk(0); } else { pool->run(parse_chunk); }
+            std::size_t block_edges = 0;
+            for (int i = 0; i < chunks; ++i) {
+                if (!parts[i].error.empty()) { throw std::runtime_error("edge list: " + parts[i].error); }
+                vertices = std::max(vertices, parts[i].vertices);
+                if (chunks > 1) { block_edges += parts[i].edges.size(); }
+            }
+            // Grown at least geometrically once per block, so appending stays linear in the size of the file.
+            if (edges.size() + block_edges > edges.capacity()) {
+                edges.reserve(std::max(edges.size() + block_edges, 2 * edges.capacity()));
+            }
+            for (int i = 0; i < chunks && chunks > 1; ++i) {
+                // Appended one by one, since an 'Edge' with const members can't be assigned.
+                for (const auto &e: parts[i].edges) { edges.push_back(e); }
+                parts[i].edges.clear();
+            }
+
+            carry = buffer.data() + size - end;
+            std::memmove(buffer.data(), end, carry);
+        }
+        if (in_preamble) { throw std::runtime_error("edge list: missing header in " + path); }
+        return {static_cast<int>(std::max(vertices, declared_vertices)), std::move(edges)};
+    }
+};
+
+template<typename Edge>
+parsed_edge_list<Edge> parse_edge_list(const std::string &path, edge_list_format format) {
+    return edge_list_parser<Edge>(format).parse(path, nullptr);
+}
+
+// Same as above, splitting the lines of every block among the threads of 'pool'.
+template<typename Edge>
+parsed_edge_list<Edge> parse_edge_list(const std::string &path, edge_list_format format, thread_pool &pool) {
+    return edge_list_parser<Edge>(format).parse(path, &pool);
+}
+
+#endif  // ALGORITHMS_GRAPHS_EDGE_LIST_PARSER_H
@@ -0,0 +1,145 @@
+#ifndef ALGORITHMS_GRAPHS_GRAPH_FILE_H
+#define ALGORITHMS_GRAPHS_GRAPH_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csr_graph.h"
+
+// Binary file holding a 'csr_graph', laid out so that it can be used straight from a memory mapping:
+//   header (64 bytes), offsets (V+1 int32), targets (E int32), costs (E double), coordinates (2V double)
+// Every section starts at a multiple of 8 bytes, padded with zeros. The coordinates (x and y of every vertex,
+// e.g. for an A* heuristic) are optional. Numbers are stored in the byte order of the machine that wrote the
+// file, so a file written on a machine with the other byte order is rejected instead of converted.
+constexpr std::uint32_t GRAPH_FILE_MAGIC = 0x47525343;  // "CSRG" in little endian.
+constexpr std::uint32_t GRAPH_FILE_VERSION = 1;
+constexpr std::uint32_t GRAPH_FILE_HAS_COORDS = 1;
+
+struct graph_file_header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t vertices;
+    std::uint64_t edges;
+    std::uint32_t flags;
+    std::uint32_t reserved[9];
+};
+static_assert(sizeof(graph_file_header) == 64, "the header of a graph file takes 64 bytes");
+
+// Byte offsets of the sections of a graph file, which only depend on its header.
+struct graph_file_layout {
+    std::size_t offsets, targets, costs, coords, size;
+    explicit graph_file_layout(const graph_file_header &header) {
+        const auto align = [](std::size_t position) { return (position + 7) / 8 * 8; };
+        offsets = sizeof(graph_file_header);
+        targets = align(offsets + (header.vertices + 1) * sizeof(std::int32_t));
+        costs = align(targets + header.edges * sizeof(std::int32_t));
+        coords = costs + header.edges * sizeof(double);
+        size = coords + ((header.flags & GRAPH_FILE_HAS_COORDS) ? 2 * header.vertices * sizeof(double) : 0);
+    }
+};
+
+// Writes 'graph' to 'out', with the coordinates of its vertices if 'coords' is not empty (x and y of vertex v
+// at coords[2v] and coords[2v + 1]).
+inline void write_graph_file(std::ostream &out, const csr_graph &graph, const std::vector<double> &coords = {}) {
+    const std::size_t vertices = graph.size(), edges = graph.edge_count();
+    if (!coords.empty() && coords.size() != 2 * vertices) {
+        throw std::runtime_error("graph file: there must be two coordinates per vertex");
+    }
+    graph_file_header header = {};
+    header.magic = GRAPH_FILE_MAGIC;
+    header.version = GRAPH_FILE_VERSION;
+    header.vertices = vertices;
+    header.edges = edges;
+    header.flags = coords.empty() ? 0 : GRAPH_FILE_HAS_COORDS;
+    const graph_file_layout layout(header);
+
+    std::vector<std::int32_t> offsets(vertices + 1, 0), targets;
+    std::vector<double> costs;
+    targets.reserve(edges);
+    costs.reserve(edges);
+    for (std::size_t v = 0; v < vertices; ++v) {
+        offsets[v + 1] = offsets[v] + graph.degree(static_cast<int>(v));
+        for (const auto edge: graph.adj_list(static_cast<int>(v))) {
+            targets.push_back(edge.to);
+            costs.push_back(edge.cost);
+        }
+    }
+    const char padding[8] = {};
+    std::size_t position = 0;
+    const auto write = [&](std::size_t section, const void *data, std::size_t bytes) {
+        out.write(padding, static_cast<std::streamsize>(section - position));
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        position = section + bytes;
+    };
+    write(0, &header, sizeof(header));
+    write(layout.offsets, offsets.data(), offsets.size() * sizeof(std::int32_t));
+    write(layout.targets, targets.data(), targets.size() * sizeof(std::int32_t));
+    write(layout.costs, costs.data(), costs.size() * sizeof(double));
+    write(layout.coords, coords.data(), coords.size() * sizeof(double));
+    if (!out) { throw std::runtime_error("graph file: write failed"); }
+}
+
+// Graph mapped from a file, with the optional coordinates of its vertices.
+struct mapped_graph {
+    const csr_graph graph;
+    // x and y of vertex v at coords[2v] and coords[2v + 1], or nullptr if the file has none.
+    const double *const coords;
+};
+
+// Maps a graph file in memory. The graph points straight into the mapped pages, which are only read from disk
+// when they are first touched, so loading takes O(1) whatever the size of the graph, and all the processes
+// that map the same file share a single copy of it in the page cache. Only the header and the total number
+// of edges are checked, the rest of the file is trusted. The mapping is released together with the last copy
+// of the graph.
+inline mapped_graph map_graph_file(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) { throw std::runtime_error("graph file: can't open " + path); }
+    struct stat status = {};
+    if (fstat(fd, &status) == -1) {
+        close(fd);
+        throw std::runtime_error("graph file: can't stat " + path);
+    }
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    void *data = size < sizeof(graph_file_header) ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (data == MAP_FAILED) { throw std::runtime_error("graph file: can't map " + path); }
+    const std::shared_ptr<const void> memory(data, [size](const void *p) { munmap(const_cast<void *>(p), size); });
+
+    graph_file_header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic == __builtin_bswap32(GRAPH_FILE_MAGIC)) {
+        throw std::runtime_error("graph file: written on a machine with a different byte order");
+    }
+    if (header.magic != GRAPH_FILE_MAGIC) { throw std::runtime_error("graph file: bad magic number"); }
+    if (header.version != GRAPH_FILE_VERSION) { throw std::runtime_error("graph file: unsupported version"); }
+    if (header.vertices >= static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+        || header.edges > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("graph file: too large");
+    }
+    const graph_file_layout layout(header);
+    const char *bytes = static_cast<const char *>(data);
+    const auto *offsets = reinterpret_cast<const int *>(bytes + layout.offsets);
+    if (size < layout.size || offsets[header.vertices] != static_cast<int>(header.edges)) {
+        throw std::runtime_error("graph file: truncated or corrupted");
+    }
+    const auto *coords = (header.flags & GRAPH_FILE_HAS_COORDS)
+                         ? reinterpret_cast<const double *>(bytes + layout.coords) : nullptr;
+    return {csr_graph(static_cast<int>(header.vertices), header.edges, offsets,
+                      reinterpret_cast<const int *>(bytes + layout.targets),
+                      reinterpret_cast<const double *>(bytes + layout.costs), memory), coords};
+}
+
+#endif  // ALGORITHMS_GRAPHS_GRAPH_FILE_H
@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <vector>
 
+#include "../edge_list_parser.h"
+#include "../temporary_file.h"
+
 class UnionFind {
 private:
     // Track the union of the components in the union find.
@@ -168,5 +172,21 @@ int main() {
         const kruskal_result result = kruskal(10, edges);
         display_minimum_spanning_tree(result);
     }
+    std::cout << "Example 3" << std::endl;  // resources/graph_weighted_1.svg
+    {
+        // The same graph as a symmetric Matrix Market file: only the lower triangle is stored, numbered from 1.
+        const temporary_file file(".mtx");
+        {
+            std::ofstream out(file.path());
+            out << "%%MatrixMarket matrix coordinate real symmetric\n"
+                   "% resources/graph_weighted_1.svg\n"
+                   "8 8 14\n"
+                   "2 1 10\n3 1 1\n4 1 4\n3 2 3\n5 2 0\n4 3 2\n6 3 8\n"
+                   "6 4 2\n7 4 7\n6 5 1\n8 5 8\n7 6 6\n8 6 9\n8 7 12\n";
+        }
+        const parsed_edge_list<edge> g = parse_edge_list<edge>(file.path(), edge_list_format::matrix_market);
+        const kruskal_result result = kruskal(g.vertices, g.edges);
+        display_minimum_spanning_tree(result);
+    }
     return 0;
 }
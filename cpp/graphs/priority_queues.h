@@ -0,0 +1,195 @@
+#ifndef ALGORITHMS_GRAPHS_PRIORITY_QUEUES_H
+#define ALGORITHMS_GRAPHS_PRIORITY_QUEUES_H
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Priority queues of vertices keyed by their tentative distance, interchangeable as the 'PriorityQueue'
+// policy of the graph algorithms. All of them share the same interface: 'push(vertex, key)' inserts a vertex
+// or lowers its key, and 'top'/'top_key'/'pop' give access to the vertex with the smallest key.
+
+// The following two queues are built with the number of vertices, and break ties by the smaller vertex.
+
+// Binary heap from the STL with 'Lazy Deletion'. 'std::priority_queue' can't decrease the key of an element,
+// so 'push' always inserts a new (key, vertex) pair and leaves the old ones inside. A vertex can therefore be
+// popped several times, and the caller must skip the outdated pairs (those whose key is greater than the
+// current distance of the vertex). The queue may grow up to O(E) entries.
+class lazy_priority_queue {
+private:
+    typedef std::pair<double, int> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<>> pq;
+public:
+    explicit lazy_priority_queue(int) {}
+    bool empty() const { return pq.empty(); }
+    int top() const { return pq.top().second; }
+    double top_key() const { return pq.top().first; }
+    void pop() { pq.pop(); }
+    void push(int vertex, double key) { pq.push({key, vertex}); }
+};
+
+// Indexed D-ary heap with a real decrease-key. 'position' maps every vertex to its slot in the heap, so a
+// vertex is stored at most once and the heap never holds more than V entries. With D = 4 the tree is half
+// as deep as a binary heap, which makes 'push'/decrease-key (the frequent operation in Dijkstra) cheaper,
+// and the D children of a node are contiguous in memory, which keeps 'pop' cache friendly.
+template<int D = 4>
+class indexed_dary_heap {
+private:
+    struct entry {
+        double key;
+        int vertex;
+        bool operator<(const entry &other) const {
+            return key < other.key || (key == other.key && vertex < other.vertex);
+        }
+    };
+    std::vector<entry> heap;
+    // position[v] is the index of vertex v in 'heap', or -1 if it is not in the heap.
+    std::vector<int> position;
+
+    void place(int i, const entry &e) {
+        heap[i] = e;
+        position[e.vertex] = i;
+    }
+    void sift_up(int i) {
+        const entry e = heap[i];
+        while (i > 0 && e < heap[(i - 1) / D]) {
+            place(i, heap[(i - 1) / D]);
+            i = (i - 1) / D;
+        }
+        place(i, e);
+    }
+    void sift_down(int i) {
+        const entry e = heap[i];
+        const int size = static_cast<int>(heap.size());
+        while (true) {
+            const int first_child = i * D + 1;
+            if (first_child >= size) { break; }
+            int min_child = first_child;
+            const int last_child = first_child + D < size ? first_child + D : size;
+            for (int child = first_child + 1; child < last_child; ++child) {
+                if (heap[child] < heap[min_child]) { min_child = child; }
+            }
+            if (!(heap[min_child] < e)) { break; }
+            place(i, heap[min_child]);
+            i = min_child;
+        }
+        place(i, e);
+    }
+public:
+    explicit indexed_dary_heap(int vertices) : position(vertices, -1) {}
+    bool empty() const { return heap.empty(); }
+    int size() const { return static_cast<int>(heap.size()); }
+    bool contains(int vertex) const { return position[vertex] != -1; }
+    int top() const { return heap.front().vertex; }
+    double top_key() const { return heap.front().key; }
+    // Empties the heap in O(size), so it can be reused by many small searches over a large graph.
+    void clear() {
+        for (const auto &e: heap) { position[e.vertex] = -1; }
+        heap.clear();
+    }
+    void pop() {
+        position[heap.front().vertex] = -1;
+        const entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap.front() = last;
+            sift_down(0);
+        }
+    }
+    void push(int vertex, double key) {
+        if (position[vertex] == -1) {
+            heap.push_back({key, vertex});
+            sift_up(static_cast<int>(heap.size()) - 1);
+        } else if (key < heap[position[vertex]].key) {
+            heap[position[vertex]].key = key;
+            sift_up(position[vertex]);
+        }
+    }
+};
+
+// The following queues only work with non-negative integer keys and are 'monotone': a pushed key can never be
+// smaller than the last popped one, which always holds in Dijkstra with non-negative integer weights. They
+// are built with the number of vertices and the maximum edge weight, and they use lazy deletion like
+// 'lazy_priority_queue' (outdated entries must be skipped by the caller).
+
+// Radix heap (Ahuja, Mehlhorn, Orlin & Tarjan, 1990). An entry with key k goes into bucket i, where i - 1 is
+// the position of the highest bit in which k differs from the last popped key (bucket 0 holds the keys equal
+// to it). Popping from an empty bucket 0 redistributes the first non-empty bucket, and since an entry can
+// only move to lower buckets, each one is moved at most 64 times. Operations take O(log C) amortized time
+// regardless of the number of vertices.
+class radix_heap {
+private:
+    typedef std::pair<std::uint64_t, int> entry;
+    std::vector<entry> buckets[65];
+    std::uint64_t last = 0;
+    int count = 0;
+
+    int bucket_index(std::uint64_t key) const {
+        return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+    }
+    // Makes sure that bucket 0 holds the minimum key. This is only done when the minimum is requested, since
+    // moving 'last' forward earlier could leave it above a key pushed later.
+    void refill() {
+        if (!buckets[0].empty()) { return; }
+        int i = 1;
+        while (buckets[i].empty()) { ++i; }
+        last = buckets[i][0].first;
+        for (const auto &e: buckets[i]) {
+            if (e.first < last) { last = e.first; }
+        }
+        for (const auto &e: buckets[i]) {
+            buckets[bucket_index(e.first)].push_back(e);
+        }
+        buckets[i].clear();
+    }
+public:
+    radix_heap(int, std::uint64_t) {}
+    bool empty() const { return count == 0; }
+    int top() { refill(); return buckets[0].back().second; }
+    std::uint64_t top_key() { refill(); return last; }
+    void pop() {
+        refill();
+        buckets[0].pop_back();
+        --count;
+    }
+    void push(int vertex, std::uint64_t key) {
+        buckets[bucket_index(key)].push_back({key, vertex});
+        ++count;
+    }
+};
+
+// Dial's bucket queue (1969). All the keys in the queue lie in [current, current + C], where C is the maximum
+// edge weight, so a circular array of C + 1 buckets indexed by 'key % (C + 1)' holds every key in its own
+// bucket. Popping walks forward to the next non-empty bucket, which makes a whole Dijkstra run O(V*C + E).
+// It is the best choice when C is small.
+class bucket_queue {
+private:
+    std::vector<std::vector<int>> buckets;
+    std::uint64_t current = 0;
+    int count = 0;
+
+    std::vector<int> &bucket(std::uint64_t key) { return buckets[key % buckets.size()]; }
+    // Makes sure that 'current' points to the bucket with the minimum key. As in 'radix_heap', this is only
+    // done when the minimum is requested.
+    void advance() {
+        while (bucket(current).empty()) { ++current; }
+    }
+public:
+    bucket_queue(int, std::uint64_t max_weight) : buckets(max_weight + 1) {}
+    bool empty() const { return count == 0; }
+    int top() { advance(); return bucket(current).back(); }
+    std::uint64_t top_key() { advance(); return current; }
+    void pop() {
+        advance();
+        bucket(current).pop_back();
+        --count;
+    }
+    void push(int vertex, std::uint64_t key) {
+        bucket(key).push_back(vertex);
+        ++count;
+    }
+};
+
+#endif  // ALGORITHMS_GRAPHS_PRIORITY_QUEUES_H
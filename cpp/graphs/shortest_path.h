@@ -0,0 +1,419 @@
+#ifndef ALGORITHMS_GRAPHS_SHORTEST_PATH_H
+#define ALGORITHMS_GRAPHS_SHORTEST_PATH_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Templated versions of the graph representations and of the basic shortest path algorithms of
+// 'shortest_path/', resolved at compile time. Every representation takes two parameters:
+// - 'Weight': the type of the edge costs (e.g. double, float, std::int32_t, std::int64_t), or void for an
+//   unweighted graph, in which case no cost is stored at all and every edge counts as 1.
+// - 'Vertex': the unsigned type of the vertex indices (std::uint32_t or std::uint64_t). CSR offsets use the
+//   same type, so a graph with 32-bit indices can have up to 2^32 - 1 edges.
+// The representations ('basic_adj_list', 'basic_adj_matrix', 'basic_edge_list' and 'basic_csr_graph') share
+// the same interface, and 'bfs', 'dijkstra' and 'bellman_ford' work on any of them. 'for_each_arc' is only
+// provided by the representations that can list the outgoing edges of a vertex without a full scan, so
+// running Dijkstra on an edge list is a compile error instead of a silent O(VE).
+
+// Cost of an edge of an unweighted graph. It takes no storage and reads as 1, so the algorithms add it to a
+// distance like any other weight and the compiler folds it into an increment.
+struct unit_weight {
+    constexpr operator int() const { return 1; }
+};
+
+// Type and special values of the distances computed for a graph. Unweighted distances are hop counts,
+// which always fit in the vertex index type. Integer weights use max() as infinity and lowest() as negative
+// infinity, which only marks vertices reachable from negative cycles. Unsigned and void weights can't form
+// such cycles, so their negative infinity is just infinity again and never shows up in a result.
+template<typename Weight, typename Vertex>
+struct distance_traits {
+    typedef Weight type;
+    static constexpr type infinity() {
+        return std::numeric_limits<type>::has_infinity ? std::numeric_limits<type>::infinity()
+                                                       : std::numeric_limits<type>::max();
+    }
+    static constexpr type negative_infinity() {
+        return std::numeric_limits<type>::has_infinity ? -std::numeric_limits<type>::infinity()
+                                                       : std::numeric_limits<type>::is_signed
+                                                         ? std::numeric_limits<type>::lowest()
+                                                         : std::numeric_limits<type>::max();
+    }
+};
+
+template<typename Vertex>
+struct distance_traits<void, Vertex> {
+    typedef Vertex type;
+    static constexpr type infinity() { return std::numeric_limits<type>::max(); }
+    static constexpr type negative_infinity() { return std::numeric_limits<type>::max(); }
+};
+
+// Marks the absence of a vertex (e.g. the parent of the source), since the indices are unsigned.
+template<typename Vertex>
+constexpr Vertex no_vertex() {
+    static_assert(std::is_unsigned<Vertex>::value, "vertex indices must be unsigned");
+    return std::numeric_limits<Vertex>::max();
+}
+
+// Directed edge with a cost. The unweighted one has a static 'cost', so it is just two indices in memory.
+template<typename Weight, typename Vertex>
+struct basic_edge {
+    Vertex from, to;
+    Weight cost;
+};
+
+template<typename Vertex>
+struct basic_edge<void, Vertex> {
+    Vertex from, to;
+    static constexpr unit_weight cost{};
+};
+
+template<typename Vertex>
+constexpr unit_weight basic_edge<void, Vertex>::cost;
+
+// Outgoing edge of a vertex, as stored in an adjacency list.
+template<typename Weight, typename Vertex>
+struct basic_arc {
+    Vertex to;
+    Weight cost;
+};
+
+template<typename Vertex>
+struct basic_arc<void, Vertex> {
+    Vertex to;
+    static constexpr unit_weight cost{};
+};
+
+template<typename Vertex>
+constexpr unit_weight basic_arc<void, Vertex>::cost;
+
+template<typename Weight, typename Vertex>
+basic_arc<Weight, Vertex> make_arc(const basic_edge<Weight, Vertex> &e) { return {e.to, e.cost}; }
+
+template<typename Vertex>
+basic_arc<void, Vertex> make_arc(const basic_edge<void, Vertex> &e) { return {e.to}; }
+
+// Array of edge costs, empty for unweighted graphs.
+template<typename Weight>
+class cost_array {
+private:
+    std::vector<Weight> costs;
+public:
+    void resize(std::size_t size) { costs.resize(size); }
+    void set(std::size_t i, Weight cost) { costs[i] = cost; }
+    Weight operator[](std::size_t i) const { return costs[i]; }
+    std::size_t memory_bytes() const { return costs.capacity() * sizeof(Weight); }
+};
+
+template<>
+class cost_array<void> {
+public:
+    void resize(std::size_t) {}
+    void set(std::size_t, unit_weight) {}
+    unit_weight operator[](std::size_t) const { return {}; }
+    std::size_t memory_bytes() const { return 0; }
+};
+
+// Plain list of edges. It has no 'for_each_arc', so only Bellman-Ford runs on it directly.
+template<typename Weight = double, typename Vertex = std::uint32_t>
+class basic_edge_list {
+public:
+    typedef Weight weight_type;
+    typedef Vertex vertex_type;
+    typedef basic_edge<Weight, Vertex> edge_type;
+private:
+    Vertex vertices;
+    std::vector<edge_type> edges;
+public:
+    basic_edge_list(Vertex vertices, std::vector<edge_type> edges) : vertices(vertices), edges(std::move(edges)) {}
+    Vertex size() const { return vertices; }
+    std::size_t edge_count() const { return edges.size(); }
+    // Calls 'f(from, to, cost)' for every edge.
+    template<typename F>
+    void for_each_edge(const F &f) const {
+        for (const auto &e: edges) { f(e.from, e.to, e.cost); }
+    }
+    std::size_t memory_bytes() const { return edges.capacity() * sizeof(edge_type); }
+};
+
+// One vector of outgoing edges per vertex.
+template<typename Weight = double, typename Vertex = std::uint32_t>
+class basic_adj_list {
+public:
+    typedef Weight weight_type;
+    typedef Vertex vertex_type;
+    typedef basic_edge<Weight, Vertex> edge_type;
+private:
+    std::vector<std::vector<basic_arc<Weight, Vertex>>> lists;
+public:
+    basic_adj_list(Vertex vertices, const std::vector<edge_type> &edges) : lists(vertices) {
+        for (const auto &e: edges) {
+            assert(e.from < vertices && e.to < vertices);
+            lists[e.from].push_back(make_arc(e));
+        }
+    }
+    Vertex size() const { return static_cast<Vertex>(lists.size()); }
+    // Calls 'f(to, cost)' for every outgoing edge of 'vertex'.
+    template<typename F>
+    void for_each_arc(Vertex vertex, const F &f) const {
+        for (const auto &a: lists[vertex]) { f(a.to, a.cost); }
+    }
+    template<typename F>
+    void for_each_edge(const F &f) const {
+        for (Vertex v = 0; v < size(); ++v) {
+            for (const auto &a: lists[v]) { f(v, a.to, a.cost); }
+        }
+    }
+    std::size_t memory_bytes() const {
+        std::size_t bytes = lists.capacity() * sizeof(lists[0]);
+        for (const auto &list: lists) { bytes += list.capacity() * sizeof(basic_arc<Weight, Vertex>); }
+        return bytes;
+    }
+};
+
+// V x V matrix of costs, where the distance infinity means that there is no edge. Parallel edges keep the
+// cheapest cost. Scanning the outgoing edges of a vertex takes O(V).
+template<typename Weight = double, typename Vertex = std::uint32_t>
+class basic_adj_matrix {
+public:
+    typedef Weight weight_type;
+    typedef Vertex vertex_type;
+    typedef basic_edge<Weight, Vertex> edge_type;
+private:
+    Vertex vertices;
+    std::vector<Weight> cells;
+public:
+    basic_adj_matrix(Vertex vertices, const std::vector<edge_type> &edges)
+            : vertices(vertices),
+              cells(static_cast<std::size_t>(vertices) * vertices, distance_traits<Weight, Vertex>::infinity()) {
+        for (const auto &e: edges) {
+            assert(e.from < vertices && e.to < vertices);
+            Weight &cell = cells[static_cast<std::size_t>(e.from) * vertices + e.to];
+            if (e.cost < cell) { cell = e.cost; }
+        }
+    }
+    Vertex size() const { return vertices; }
+    template<typename F>
+    void for_each_arc(Vertex vertex, const F &f) const {
+        const Weight *row = cells.data() + static_cast<std::size_t>(vertex) * vertices;
+        for (Vertex to = 0; to < vertices; ++to) {
+            if (row[to] != distance_traits<Weight, Vertex>::infinity()) { f(to, row[to]); }
+        }
+    }
+    template<typename F>
+    void for_each_edge(const F &f) const {
+        for (Vertex v = 0; v < vertices; ++v) {
+            for_each_arc(v, [&](Vertex to, Weight cost) { f(v, to, cost); });
+        }
+    }
+    std::size_t memory_bytes() const { return cells.capacity() * sizeof(Weight); }
+};
+
+// The unweighted matrix is a bitset (see 2_bfs_adj_matrix.cpp): V^2/8 bytes, and the outgoing edges of a
+// vertex are found 64 candidates at a time.
+template<typename Vertex>
+class basic_adj_matrix<void, Vertex> {
+public:
+    typedef void weight_type;
+    typedef Vertex vertex_type;
+    typedef basic_edge<void, Vertex> edge_type;
+private:
+    Vertex vertices;
+    std::size_t row_words;
+    std::vector<std::uint64_t> bits;
+public:
+    basic_adj_matrix(Vertex vertices, const std::vector<edge_type> &edges)
+            : vertices(vertices), row_words((static_cast<std::size_t>(vertices) + 63) / 64),
+              bits(vertices * row_words, 0) {
+        for (const auto &e: edges) {
+            assert(e.from < vertices && e.to < vertices);
+            bits[e.from * row_words + (e.to >> 6)] |= std::uint64_t{1} << (e.to & 63);
+        }
+    }
+    Vertex size() const { return vertices; }
+    template<typename F>
+    void for_each_arc(Vertex vertex, const F &f) const {
+        const std::uint64_t *row = bits.data() + vertex * row_words;
+        for (std::size_t w = 0; w < row_words; ++w) {
+            for (std::uint64_t word = row[w]; word != 0; word &= word - 1) {
+                f(static_cast<Vertex>(w * 64 + __builtin_ctzll(word)), unit_weight());
+            }
+        }
+    }
+    template<typename F>
+    void for_each_edge(const F &f) const {
+        for (Vertex v = 0; v < vertices; ++v) {
+            for_each_arc(v, [&](Vertex to, unit_weight cost) { f(v, to, cost); });
+        }
+    }
+    std::size_t memory_bytes() const { return bits.capacity() * sizeof(std::uint64_t); }
+};
+
+// Compressed Sparse Row graph (see csr_graph.h) with 'Vertex' offsets and targets, and a cost array that
+// disappears for unweighted graphs. An unweighted graph with 32-bit indices takes 4 bytes per edge, a third
+// of the 12 bytes (int target + double cost) of 'csr_graph'.
+template<typename Weight = double, typename Vertex = std::uint32_t>
+class basic_csr_graph {
+public:
+    typedef Weight weight_type;
+    typedef Vertex vertex_type;
+    typedef basic_edge<Weight, Vertex> edge_type;
+private:
+    std::vector<Vertex> offsets;
+    std::vector<Vertex> targets;
+    cost_array<Weight> costs;
+public:
+    // Builds the graph in O(V+E) with a counting sort on 'from', as 'csr_graph' does.
+    basic_csr_graph(Vertex vertices, const std::vector<edge_type> &edges)
+            : offsets(static_cast<std::size_t>(vertices) + 1, 0), targets(edges.size()) {
+        assert(edges.size() < no_vertex<Vertex>());
+        costs.resize(edges.size());
+        for (const auto &e: edges) {
+            assert(e.from < vertices && e.to < vertices);
+            ++offsets[e.from + 1];
+        }
+        for (Vertex v = 0; v < vertices; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<Vertex> next(offsets.begin(), offsets.end() - 1);
+        for (const auto &e: edges) {
+            const Vertex i = next[e.from]++;
+            targets[i] = e.to;
+            costs.set(i, e.cost);
+        }
+    }
+    Vertex size() const { return static_cast<Vertex>(offsets.size() - 1); }
+    std::size_t edge_count() const { return targets.size(); }
+    template<typename F>
+    void for_each_arc(Vertex vertex, const F &f) const {
+        for (Vertex i = offsets[vertex]; i < offsets[vertex + 1]; ++i) { f(targets[i], costs[i]); }
+    }
+    template<typename F>
+    void for_each_edge(const F &f) const {
+        for (Vertex v = 0; v < size(); ++v) {
+            for (Vertex i = offsets[v]; i < offsets[v + 1]; ++i) { f(v, targets[i], costs[i]); }
+        }
+    }
+    std::size_t memory_bytes() const {
+        return (offsets.capacity() + targets.capacity()) * sizeof(Vertex) + costs.memory_bytes();
+    }
+};
+
+template<typename Weight, typename Vertex>
+struct basic_shortest_path_result {
+    typedef Vertex vertex_type;
+    typedef distance_traits<Weight, Vertex> traits;
+    typedef typename traits::type distance_type;
+    const vertex_type src_vertex;
+    // dist[i] is traits::infinity() if vertex i is unreachable, traits::negative_infinity() if it is reachable
+    // from a negative cycle (Bellman-Ford only).
+    const std::vector<distance_type> dist;
+    // parent[i] is the vertex before i in the shortest path, or no_vertex() if there is none.
+    const std::vector<vertex_type> parent;
+};
+
+// Result of the algorithms on a graph, which only depends on its weight and vertex types.
+template<typename Graph>
+using shortest_path_result_of = basic_shortest_path_result<typename Graph::weight_type, typename Graph::vertex_type>;
+
+// Breadth First Search. The distances are numbers of edges, whatever the weights of the graph.
+template<typename Graph>
+shortest_path_result_of<Graph> bfs(const Graph &graph, typename Graph::vertex_type src_vertex) {
+    typedef shortest_path_result_of<Graph> result;
+    typedef typename Graph::vertex_type Vertex;
+    std::vector<typename result::distance_type> dist(graph.size(), result::traits::infinity());
+    dist[src_vertex] = 0;
+    std::vector<Vertex> parent(graph.size(), no_vertex<Vertex>());
+    // Every vertex enters the queue once, so a vector read from 'head' is enough.
+    std::vector<Vertex> queue{src_vertex};
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const Vertex vertex = queue[head];
+        graph.for_each_arc(vertex, [&](Vertex to, auto) {
+            if (dist[to] == result::traits::infinity()) {
+                dist[to] = dist[vertex] + 1;
+                parent[to] = vertex;
+                queue.push_back(to);
+            }
+        });
+    }
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Dijkstra with a binary heap and lazy deletion. The keys are 'distance_type' itself, so integer distances
+// are compared exactly (an 'indexed_dary_heap' would round 64-bit keys to double). Weights must be >= 0.
+template<typename Graph>
+shortest_path_result_of<Graph> dijkstra(const Graph &graph, typename Graph::vertex_type src_vertex) {
+    typedef shortest_path_result_of<Graph> result;
+    typedef typename Graph::vertex_type Vertex;
+    typedef typename result::distance_type Distance;
+    std::vector<Distance> dist(graph.size(), result::traits::infinity());
+    dist[src_vertex] = 0;
+    std::vector<Vertex> parent(graph.size(), no_vertex<Vertex>());
+    typedef std::pair<Distance, Vertex> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<>> pq;
+    pq.push({0, src_vertex});
+    while (!pq.empty()) {
+        const Distance key = pq.top().first;
+        const Vertex vertex = pq.top().second;
+        pq.pop();
+        if (key > dist[vertex]) { continue; }
+        graph.for_each_arc(vertex, [&](Vertex to, auto cost) {
+            const Distance candidate = static_cast<Distance>(dist[vertex] + cost);
+            if (candidate < dist[to]) {
+                dist[to] = candidate;
+                parent[to] = vertex;
+                pq.push({candidate, to});
+            }
+        });
+    }
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Bellman-Ford over 'for_each_edge', as in 9_bellman_ford_edge_list.cpp: up to V-1 rounds relaxing every
+// edge, then up to V more rounds that mark with negative infinity the vertices reachable from a negative
+// cycle. Infinite distances are never added to, so integer infinities can't overflow.
+template<typename Graph>
+shortest_path_result_of<Graph> bellman_ford(const Graph &graph, typename Graph::vertex_type src_vertex) {
+    typedef shortest_path_result_of<Graph> result;
+    typedef typename Graph::vertex_type Vertex;
+    typedef typename result::distance_type Distance;
+    const Distance infinity = result::traits::infinity(), negative_infinity = result::traits::negative_infinity();
+    const Vertex vertices = graph.size();
+    std::vector<Distance> dist(vertices, infinity);
+    dist[src_vertex] = 0;
+    std::vector<Vertex> parent(vertices, no_vertex<Vertex>());
+
+    bool some_edge_relaxed = true;
+    for (Vertex _ = 1; _ < vertices && some_edge_relaxed; ++_) {
+        some_edge_relaxed = false;
+        graph.for_each_edge([&](Vertex from, Vertex to, auto cost) {
+            if (dist[from] == infinity) { return; }
+            const Distance candidate = static_cast<Distance>(dist[from] + cost);
+            if (candidate < dist[to]) {
+                dist[to] = candidate;
+                parent[to] = from;
+                some_edge_relaxed = true;
+            }
+        });
+    }
+    for (Vertex _ = 0; _ < vertices && some_edge_relaxed; ++_) {
+        some_edge_relaxed = false;
+        graph.for_each_edge([&](Vertex from, Vertex to, auto cost) {
+            if (dist[from] == infinity || dist[to] == negative_infinity) { return; }
+            if (dist[from] == negative_infinity || static_cast<Distance>(dist[from] + cost) < dist[to]) {
+                dist[to] = negative_infinity;
+                parent[to] = no_vertex<Vertex>();
+                some_edge_relaxed = true;
+            }
+        });
+    }
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+#endif  // ALGORITHMS_GRAPHS_SHORTEST_PATH_H
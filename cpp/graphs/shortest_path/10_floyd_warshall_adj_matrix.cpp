@@ -1,19 +1,94 @@
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "../thread_pool.h"
+
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 constexpr double NEGATIVE_INFINITY = -POSITIVE_INFINITY;
 
 typedef std::vector<std::vector<double>> adj_matrix;
 typedef std::vector<std::vector<int>> parent_matrix;
 
+// Default side of the square tiles of 'floyd_warshall_blocked'. The three tiles used at a time, with their
+// parents (36 KB in total), fit in the L1 data cache of recent CPUs.
+constexpr int FW_TILE_SIZE = 32;
+
 struct floyd_warshall_result {
     const adj_matrix dp;
     const parent_matrix parent;
 };
 
+// Square matrix stored row by row in a single buffer. Every row starts at a multiple of 64 bytes (a cache line,
+// and the width of the widest SIMD registers), so rows are padded up to 'stride' elements. 'm[i][j]' works as
+// with a vector of vectors, but the whole matrix is one allocation and walking a row is a sequential read.
+template<typename T>
+class flat_matrix {
+private:
+    static constexpr std::size_t ALIGNMENT = 64;
+    int n = 0;
+    std::size_t stride = 0;
+    std::unique_ptr<T[]> storage;
+    T *base = nullptr;
+public:
+    flat_matrix() = default;
+    flat_matrix(int n, const T &value)
+            : n(n), stride((n * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT / sizeof(T)),
+              storage(new T[n * stride + ALIGNMENT / sizeof(T)]) {
+        // 'new' only guarantees the alignment of T, so the first aligned element of the buffer is used as base.
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.get());
+        base = storage.get() + ((ALIGNMENT - address % ALIGNMENT) % ALIGNMENT) / sizeof(T);
+        std::fill(base, base + n * stride, value);
+    }
+    flat_matrix(flat_matrix &&) = default;
+    flat_matrix &operator=(flat_matrix &&) = default;
+    int size() const { return n; }
+    T *operator[](int i) { return base + i * stride; }
+    const T *operator[](int i) const { return base + i * stride; }
+};
+
+// Sentinels of the weight types of 'floyd_warshall_blocked' (std::int32_t, std::int64_t, float or double). The
+// integer types have no infinity, so their largest and lowest values stand for it: the kernels never add
+// anything to 'infinity()', so it stays saturated, but the sum of any two finite distances must stay below it.
+// On the negative side, a negative cycle drives the distances down without bound, so the kernels saturate
+// every sum at 'floor()' (half the lowest value for the integer types), where adding two of them can't
+// overflow. The weights must not be below 'floor()', and the lengths of the paths without cycles should not
+// reach it either, since they would be clamped like those through a negative cycle.
+template<typename Weight>
+struct weight_limits {
+    static constexpr Weight floor() {
+        return std::numeric_limits<Weight>::has_infinity ? -std::numeric_limits<Weight>::infinity()
+                                                         : std::numeric_limits<Weight>::lowest() / 2;
+    }
+    static constexpr Weight infinity() {
+        return std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity()
+                                                         : std::numeric_limits<Weight>::max();
+    }
+    static constexpr Weight negative_infinity() {
+        return std::numeric_limits<Weight>::has_infinity ? -std::numeric_limits<Weight>::infinity()
+                                                         : std::numeric_limits<Weight>::lowest();
+    }
+};
+
+// Result of 'floyd_warshall_blocked', which refers to the matrices of the caller.
+template<typename Weight>
+struct floyd_warshall_view {
+    const flat_matrix<Weight> &dp;
+    const flat_matrix<int> &parent;
+};
+
 floyd_warshall_result floyd_warshall(const adj_matrix &m) {
     const int vertices = static_cast<int>(m.size());
     // This matrix is the one that will be processed by the algorithm.
@@ -57,7 +132,256 @@ floyd_warshall_result floyd_warshall(const adj_matrix &m) {
         }
     }
 
-    return {dp, parent};
+    return {std::move(dp), std::move(parent)};
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 min-plus kernels, one per weight type, for the inner loop of 'relax_tile': they relax dp_i[j] through k
+// for as many j in [j_begin, j_end) as fit in whole registers, and return the first j left to the scalar loop.
+// The comparison gives a mask of the improved lanes, which is used to blend both the new distances into 'dp_i'
+// and the parents of row k into 'parent_i', without any branch. For the integer types, the lanes where dp_k[j]
+// is infinity are removed from the mask, since adding to the sentinel would wrap around, and the sums are
+// saturated at 'weight_limits::floor()'.
+
+// The 64-bit lanes of 'mask' narrowed to the 32-bit lanes of a 4 x int register.
+__attribute__((target("avx2")))
+inline __m128i narrow_mask(__m256i mask) {
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(mask, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+__attribute__((target("avx2")))
+int relax_row_avx2(const double *dp_k, const int *parent_k, double dp_ik, double *dp_i, int *parent_i,
+                   int j_begin, int j_end) {
+    const __m256d ik = _mm256_set1_pd(dp_ik);
+    int j = j_begin;
+    for (; j + 4 <= j_end; j += 4) {
+        const __m256d candidate = _mm256_add_pd(ik, _mm256_loadu_pd(dp_k + j));
+        const __m256d current = _mm256_loadu_pd(dp_i + j);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_pd(dp_i + j, _mm256_blendv_pd(current, candidate, mask));
+        const __m128i parents = _mm_loadu_si128(reinterpret_cast<const __m128i *>(parent_i + j));
+        const __m128i new_parents = _mm_loadu_si128(reinterpret_cast<const __m128i *>(parent_k + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(parent_i + j),
+                         _mm_blendv_epi8(parents, new_parents, narrow_mask(_mm256_castpd_si256(mask))));
+    }
+    return j;
+}
+
+__attribute__((target("avx2")))
+int relax_row_avx2(const float *dp_k, const int *parent_k, float dp_ik, float *dp_i, int *parent_i,
+                   int j_begin, int j_end) {
+    const __m256 ik = _mm256_set1_ps(dp_ik);
+    int j = j_begin;
+    for (; j + 8 <= j_end; j += 8) {
+        const __m256 candidate = _mm256_add_ps(ik, _mm256_loadu_ps(dp_k + j));
+        const __m256 current = _mm256_loadu_ps(dp_i + j);
+        const __m256 mask = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_ps(dp_i + j, _mm256_blendv_ps(current, candidate, mask));
+        const __m256i parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(parent_i + j));
+        const __m256i new_parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(parent_k + j));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(parent_i + j),
+                            _mm256_blendv_epi8(parents, new_parents, _mm256_castps_si256(mask)));
+    }
+    return j;
+}
+
+__attribute__((target("avx2")))
+int relax_row_avx2(const std::int32_t *dp_k, const int *parent_k, std::int32_t dp_ik, std::int32_t *dp_i,
+                   int *parent_i, int j_begin, int j_end) {
+    const __m256i ik = _mm256_set1_epi32(dp_ik);
+    const __m256i infinity = _mm256_set1_epi32(weight_limits<std::int32_t>::infinity());
+    const __m256i floor = _mm256_set1_epi32(weight_limits<std::int32_t>::floor());
+    int j = j_begin;
+    for (; j + 8 <= j_end; j += 8) {
+        const __m256i kj = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dp_k + j));
+        const __m256i candidate = _mm256_max_epi32(_mm256_add_epi32(ik, kj), floor);
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dp_i + j));
+        const __m256i mask = _mm256_andnot_si256(_mm256_cmpeq_epi32(kj, infinity),
+                                                 _mm256_cmpgt_epi32(current, candidate));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dp_i + j), _mm256_blendv_epi8(current, candidate, mask));
+        const __m256i parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(parent_i + j));
+        const __m256i new_parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(parent_k + j));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(parent_i + j), _mm256_blendv_epi8(parents, new_parents, mask));
+    }
+    return j;
+}
+
+__attribute__((target("avx2")))
+int relax_row_avx2(const std::int64_t *dp_k, const int *parent_k, std::int64_t dp_ik, std::int64_t *dp_i,
+                   int *parent_i, int j_begin, int j_end) {
+    const __m256i ik = _mm256_set1_epi64x(dp_ik);
+    const __m256i infinity = _mm256_set1_epi64x(weight_limits<std::int64_t>::infinity());
+    const __m256i floor = _mm256_set1_epi64x(weight_limits<std::int64_t>::floor());
+    int j = j_begin;
+    for (; j + 4 <= j_end; j += 4) {
+        const __m256i kj = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dp_k + j));
+        // AVX2 has no 64-bit max.
+        const __m256i sum = _mm256_add_epi64(ik, kj);
+        const __m256i candidate = _mm256_blendv_epi8(sum, floor, _mm256_cmpgt_epi64(floor, sum));
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dp_i + j));
+        const __m256i mask = _mm256_andnot_si256(_mm256_cmpeq_epi64(kj, infinity),
+                                                 _mm256_cmpgt_epi64(current, candidate));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dp_i + j), _mm256_blendv_epi8(current, candidate, mask));
+        const __m128i parents = _mm_loadu_si128(reinterpret_cast<const __m128i *>(parent_i + j));
+        const __m128i new_parents = _mm_loadu_si128(reinterpret_cast<const __m128i *>(parent_k + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(parent_i + j),
+                         _mm_blendv_epi8(parents, new_parents, narrow_mask(mask)));
+    }
+    return j;
+}
+#endif
+
+// Whether the AVX2 kernels can run on this CPU.
+bool avx2_supported() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Relaxes the tile with rows [i_begin, i_end) and columns [j_begin, j_end) through the intermediate vertices
+// k in [k_begin, k_end), in the same k-i-j order as 'floyd_warshall'. Each row is handled by the AVX2 kernel
+// if 'avx2' is set, and the remaining columns by the scalar loop.
+template<typename Weight>
+void relax_tile(flat_matrix<Weight> &dp, flat_matrix<int> &parent, int i_begin, int i_end, int j_begin, int j_end,
+                int k_begin, int k_end, bool avx2) {
+    constexpr Weight infinity = weight_limits<Weight>::infinity();
+    constexpr Weight floor = weight_limits<Weight>::floor();
+    for (int k = k_begin; k < k_end; ++k) {
+        const Weight *dp_k = dp[k];
+        const int *parent_k = parent[k];
+        for (int i = i_begin; i < i_end; ++i) {
+            const Weight dp_ik = dp[i][k];
+            if (dp_ik == infinity) { continue; }
+            Weight *dp_i = dp[i];
+            int *parent_i = parent[i];
+            int j = j_begin;
+#if defined(__x86_64__) || defined(__i386__)
+            if (avx2) { j = relax_row_avx2(dp_k, parent_k, dp_ik, dp_i, parent_i, j_begin, j_end); }
+#endif
+            for (; j < j_end; ++j) {
+                // Both terms are at least 'floor', so the sum can't overflow.
+                if (dp_k[j] != infinity && dp_ik + dp_k[j] < dp_i[j]) {
+                    dp_i[j] = std::max(dp_ik + dp_k[j], floor);
+                    parent_i[j] = parent_k[j];
+                }
+            }
+        }
+    }
+}
+
+// Body of 'floyd_warshall_blocked'. 'for_each(count, body)' calls 'body(t)' for every t in [0, count), and
+// all those calls are independent of each other, so they may run in parallel.
+template<typename Weight, typename ForEach>
+flat_matrix<int> floyd_warshall_tiles(flat_matrix<Weight> &dp, int tile_size, const ForEach &for_each) {
+    assert(tile_size > 0);
+    constexpr Weight infinity = weight_limits<Weight>::infinity();
+    const bool avx2 = avx2_supported();
+    const int vertices = dp.size();
+    const int tiles = (vertices + tile_size - 1) / tile_size;
+    flat_matrix<int> parent(vertices, -1);
+    for (int i = 0; i < vertices; ++i) {
+        for (int j = 0; j < vertices; ++j) {
+            if (dp[i][j] != infinity) { parent[i][j] = i; }
+        }
+    }
+
+    for (int k_tile = 0; k_tile < tiles; ++k_tile) {
+        const int k_begin = k_tile * tile_size, k_end = std::min(k_begin + tile_size, vertices);
+        // Phase 1: the diagonal tile.
+        relax_tile(dp, parent, k_begin, k_end, k_begin, k_end, k_begin, k_end, avx2);
+        // Phase 2: the tiles in the row (even t) and in the column (odd t) of the diagonal one.
+        for_each(2LL * tiles, [&](long long t) {
+            if (t / 2 == k_tile) { return; }
+            const int t_begin = static_cast<int>(t / 2) * tile_size, t_end = std::min(t_begin + tile_size, vertices);
+            if (t % 2 == 0) {
+                relax_tile(dp, parent, k_begin, k_end, t_begin, t_end, k_begin, k_end, avx2);
+            } else {
+                relax_tile(dp, parent, t_begin, t_end, k_begin, k_end, k_begin, k_end, avx2);
+            }
+        });
+        // Phase 3: all the remaining tiles.
+        for_each(static_cast<long long>(tiles) * tiles, [&](long long t) {
+            const int i_tile = static_cast<int>(t / tiles), j_tile = static_cast<int>(t % tiles);
+            if (i_tile == k_tile || j_tile == k_tile) { return; }
+            const int i_begin = i_tile * tile_size, i_end = std::min(i_begin + tile_size, vertices);
+            const int j_begin = j_tile * tile_size, j_end = std::min(j_begin + tile_size, vertices);
+            relax_tile(dp, parent, i_begin, i_end, j_begin, j_end, k_begin, k_end, avx2);
+        });
+    }
+    // Same propagation of 'NEGATIVE_INFINITY' as in 'floyd_warshall', but only through the vertices k that are
+    // on a negative cycle (dp[k][k] < 0), which are usually few or none, so this step is rarely O(V^3). Row k
+    // is itself overwritten, so the vertices it reaches are taken beforehand.
+    std::vector<char> reaches(vertices);
+    for (int k = 0; k < vertices; ++k) {
+        if (!(dp[k][k] < 0)) { continue; }
+        for (int j = 0; j < vertices; ++j) { reaches[j] = dp[k][j] != infinity; }
+        for_each(vertices, [&](long long i) {
+            if (dp[i][k] == infinity) { return; }
+            for (int j = 0; j < vertices; ++j) {
+                if (reaches[j]) {
+                    dp[i][j] = weight_limits<Weight>::negative_infinity();
+                    parent[i][j] = -1;
+                }
+            }
+        });
+    }
+
+    return parent;
+}
+
+// Blocked Floyd-Warshall (Venkataraman, Sahni & Mukhopadhyaya, 2003). The naive k-i-j loops read the whole V^2
+// matrix once per k, so beyond a few hundred vertices they run at the speed of the main memory. Here the
+// matrix is split into tiles of 'tile_size' x 'tile_size', and the k loop advances a whole block of
+// 'tile_size' vertices at a time in three phases: (1) the diagonal tile of the block is solved on its own,
+// (2) the tiles in the same row or column as the diagonal one are relaxed through it, and (3) every other
+// tile (i, j) is relaxed through the tiles (i, k) and (k, j) computed in phase 2. Each phase works on at most
+// three tiles at a time, which stay in the cache while they are reused 'tile_size' times, and since the
+// order of the relaxations of each pair (i, j) is kept, the result is the same as the one of 'floyd_warshall'
+// (parents may differ among the equally short alternatives).
+// It runs in place: 'dp' holds the adjacency matrix on entry and the shortest distances on exit. The parents
+// (parent[i][j] is the vertex where vertex j comes from in the shortest path from i) are returned.
+// 'Weight' is any of the types of 'weight_limits': with 32-bit weights, every AVX2 register holds 8 distances.
+template<typename Weight>
+flat_matrix<int> floyd_warshall_blocked(flat_matrix<Weight> &dp, int tile_size = FW_TILE_SIZE) {
+    return floyd_warshall_tiles(dp, tile_size, [](long long count, const std::function<void(long long)> &body) {
+        for (long long t = 0; t < count; ++t) { body(t); }
+    });
+}
+
+// Multi-threaded 'floyd_warshall_blocked'. For every block of k, the tiles of phase 2 only depend on the
+// diagonal tile, and the tiles of phase 3 only on the tiles of phase 2, so the tiles of each phase are relaxed
+// concurrently on the threads of 'pool' (with a synchronization between phases). Every tile is written by a
+// single thread in the same order as in the sequential version, so the result does not depend on the number
+// of threads.
+template<typename Weight>
+flat_matrix<int> floyd_warshall_blocked(flat_matrix<Weight> &dp, thread_pool &pool, int tile_size = FW_TILE_SIZE) {
+    return floyd_warshall_tiles(dp, tile_size, [&](long long count, const std::function<void(long long)> &body) {
+        pool.parallel_for(0, count, 1, [&](int, long long t) { body(t); });
+    });
+}
+
+// Converts an adjacency matrix to the weight type of 'floyd_warshall_blocked', mapping POSITIVE_INFINITY to
+// its sentinel.
+template<typename Weight = double>
+flat_matrix<Weight> to_flat_matrix(const adj_matrix &m) {
+    const int vertices = static_cast<int>(m.size());
+    flat_matrix<Weight> result(vertices, weight_limits<Weight>::infinity());
+    for (int i = 0; i < vertices; ++i) {
+        for (int j = 0; j < vertices; ++j) {
+            if (m[i][j] != POSITIVE_INFINITY) { result[i][j] = static_cast<Weight>(m[i][j]); }
+        }
+    }
+    return result;
+}
+
+// A distance as a double, with the sentinels of 'Weight' mapped to POSITIVE_INFINITY and NEGATIVE_INFINITY.
+template<typename Weight>
+double as_double(Weight distance) {
+    if (distance == weight_limits<Weight>::infinity()) { return POSITIVE_INFINITY; }
+    if (distance == weight_limits<Weight>::negative_infinity()) { return NEGATIVE_INFINITY; }
+    return static_cast<double>(distance);
 }
 
 adj_matrix setup_disconnected_adjacency_matrix(int vertices) {
@@ -70,12 +394,14 @@ adj_matrix setup_disconnected_adjacency_matrix(int vertices) {
     return result;
 }
 
-void display_shortest_path(const floyd_warshall_result &result, int src_vertex, int dest_vertex) {
-    std::cout << "From " << src_vertex << " to " << dest_vertex << ": ["
-              << std::setw(4) << result.dp[src_vertex][dest_vertex] << "] ";
-    if (result.dp[src_vertex][dest_vertex] == POSITIVE_INFINITY) {
+// 'Result' is either a 'floyd_warshall_result' or a 'floyd_warshall_view' of any weight type.
+template<typename Result>
+void display_shortest_path(const Result &result, int src_vertex, int dest_vertex) {
+    const double distance = as_double(result.dp[src_vertex][dest_vertex]);
+    std::cout << "From " << src_vertex << " to " << dest_vertex << ": [" << std::setw(4) << distance << "] ";
+    if (distance == POSITIVE_INFINITY) {
         std::cout << "[unreachable]";
-    } else if (result.dp[src_vertex][dest_vertex] == NEGATIVE_INFINITY) {
+    } else if (distance == NEGATIVE_INFINITY) {
         std::cout << "[negative cycle]";
     } else {
         std::vector<int> path;
@@ -94,7 +420,8 @@ void display_shortest_path(const floyd_warshall_result &result, int src_vertex,
     std::cout << std::endl;
 }
 
-void display_all_shortest_paths(const floyd_warshall_result &result, int src_vertex) {
+template<typename Result>
+void display_all_shortest_paths(const Result &result, int src_vertex) {
     const int vertices = static_cast<int>(result.dp.size());
     for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
         display_shortest_path(result, src_vertex, dest_vertex);
@@ -193,5 +520,100 @@ int main() {
         const floyd_warshall_result result = floyd_warshall(m);
         display_all_shortest_paths(result, 1);
     }
+    std::cout << "Example 6" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        adj_matrix m = setup_disconnected_adjacency_matrix(12);
+        m[0][1] = 1;
+        m[1][2] = 8;
+        m[1][3] = 4;
+        m[1][4] = 1;
+        m[2][5] = 2;
+        m[3][5] = 2;
+        m[4][3] = 2;
+        m[4][4] = 3;
+        m[4][6] = 6;
+        m[5][2] = 1;
+        m[5][6] = 1;
+        m[5][7] = 2;
+        m[6][9] = 1;
+        m[7][8] = 1;
+        m[7][10] = 1;
+        m[8][6] = 3;
+        m[9][8] = -6;
+        m[10][10] = -1;
+        // Tiles of 5 x 5 to exercise the three phases on this small graph.
+        flat_matrix<double> dp = to_flat_matrix(m);
+        const flat_matrix<int> parent = floyd_warshall_blocked(dp, 5);
+        display_all_shortest_paths(floyd_warshall_view<double>{dp, parent}, 1);
+    }
+    std::cout << "Example 7" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        adj_matrix m = setup_disconnected_adjacency_matrix(12);
+        m[0][1] = 1;
+        m[1][2] = 8;
+        m[1][3] = 4;
+        m[1][4] = 1;
+        m[2][5] = 2;
+        m[3][5] = 2;
+        m[4][3] = 2;
+        m[4][4] = 3;
+        m[4][6] = 6;
+        m[5][2] = 1;
+        m[5][6] = 1;
+        m[5][7] = 2;
+        m[6][9] = 1;
+        m[7][8] = 1;
+        m[7][10] = 1;
+        m[8][6] = 3;
+        m[9][8] = -6;
+        m[10][10] = -1;
+        thread_pool pool(4);
+        flat_matrix<double> dp = to_flat_matrix(m);
+        const flat_matrix<int> parent = floyd_warshall_blocked(dp, pool, 5);
+        display_all_shortest_paths(floyd_warshall_view<double>{dp, parent}, 1);
+    }
+    std::cout << "Example 8" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        adj_matrix m = setup_disconnected_adjacency_matrix(12);
+        m[0][1] = 1;
+        m[1][2] = 8;
+        m[1][3] = 4;
+        m[1][4] = 1;
+        m[2][5] = 2;
+        m[3][5] = 2;
+        m[4][3] = 2;
+        m[4][4] = 3;
+        m[4][6] = 6;
+        m[5][2] = 1;
+        m[5][6] = 1;
+        m[5][7] = 2;
+        m[6][9] = 1;
+        m[7][8] = 1;
+        m[7][10] = 1;
+        m[8][6] = 3;
+        m[9][8] = -6;
+        m[10][10] = -1;
+        // Integer weights, with 8 distances per AVX2 register instead of 4.
+        flat_matrix<std::int32_t> dp = to_flat_matrix<std::int32_t>(m);
+        const flat_matrix<int> parent = floyd_warshall_blocked(dp);
+        display_all_shortest_paths(floyd_warshall_view<std::int32_t>{dp, parent}, 1);
+    }
+    std::cout << "Example 9" << std::endl;
+    {
+        // Complete graph where every edge costs -1, so every vertex is on a negative cycle. Without saturation,
+        // the int32 distances would overflow within a few blocks of k.
+        const int vertices = 40;
+        adj_matrix m(vertices, std::vector<double>(vertices, -1));
+        flat_matrix<std::int32_t> dp = to_flat_matrix<std::int32_t>(m);
+        floyd_warshall_blocked(dp, 8);
+        int negative_cycle_pairs = 0;
+        for (int i = 0; i < vertices; ++i) {
+            for (int j = 0; j < vertices; ++j) {
+                if (as_double(dp[i][j]) == NEGATIVE_INFINITY) { ++negative_cycle_pairs; }
+            }
+        }
+        std::cout << "Pairs with a path through a negative cycle: " << negative_cycle_pairs << " of "
+                  << vertices * vertices << std::endl;
+    }
     return 0;
 }
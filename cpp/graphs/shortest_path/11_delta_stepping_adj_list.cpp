@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../thread_pool.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+
+struct delta_stepping_result {
+    const int src_vertex;
+    const std::vector<double> dist;
+    const std::vector<int> parent;
+};
+
+// Delta-stepping (Meyer & Sanders, 2003) is a parallel relaxation of Dijkstra for non-negative weights. The
+// vertices are kept in buckets of width 'delta' (bucket i holds the tentative distances in [i*delta,
+// (i+1)*delta)), and instead of settling one vertex at a time, all the vertices of the lowest non-empty
+// bucket are expanded at once in parallel. Edges are split into 'light' (cost <= delta) and 'heavy' ones:
+// relaxing a light edge can put a vertex back into the current bucket, so light edges are relaxed repeatedly
+// until the bucket stays empty, while heavy edges can only reach later buckets and are relaxed once when the
+// bucket is done. A small 'delta' approaches Dijkstra (little parallelism, no wasted work), and a big one
+// approaches Bellman-Ford (lots of parallelism and re-relaxations); the cost of the heaviest edge divided by
+// the average degree is a good starting point.
+//
+// Every vertex is owned by the thread 'vertex % threads', which is the only one that reads or writes its
+// distance, parent and bucket entries. Expanding a vertex produces relaxation requests that are routed to the
+// owner of the target, and owners apply them after a barrier, so no atomics or locks are needed and the
+// distances do not depend on the number of threads.
+delta_stepping_result delta_stepping(const csr_graph &graph, int src_vertex, double delta, thread_pool &pool) {
+    assert(delta > 0);
+    const int vertices = static_cast<int>(graph.size());
+    const int threads = pool.size();
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+
+    // Every tentative distance in the buckets lies in [current*delta, current*delta + max_cost], so a circular
+    // array of buckets is enough, as in Dial's algorithm.
+    double max_cost = 0;
+    for (int vertex = 0; vertex < vertices; ++vertex) {
+        for (const auto edge: graph.adj_list(vertex)) {
+            assert(edge.cost >= 0);
+            max_cost = std::max(max_cost, edge.cost);
+        }
+    }
+    const long long bucket_count = static_cast<long long>(max_cost / delta) + 2;
+    const auto bucket_of = [delta](double distance) { return static_cast<long long>(distance / delta); };
+    // buckets[t][i % bucket_count] holds the vertices of thread t in bucket i. Entries are never removed when
+    // a distance decreases, so outdated ones (whose distance now belongs to another bucket) are skipped.
+    std::vector<std::vector<std::vector<int>>> buckets(threads, std::vector<std::vector<int>>(bucket_count));
+    buckets[src_vertex % threads][0].push_back(src_vertex);
+    // requests[t][owner] are the relaxations produced by thread t for vertices owned by 'owner'.
+    struct request {
+        int vertex, parent;
+        double distance;
+    };
+    std::vector<std::vector<std::vector<request>>> requests(threads, std::vector<std::vector<request>>(threads));
+    // Vertices of each thread expanded in the current bucket, whose heavy edges are relaxed at the end.
+    std::vector<std::vector<int>> settled(threads);
+    // Last round in which each vertex was expanded, to expand it only once per round. A vertex is only ever
+    // expanded in one bucket, since relaxations never move a vertex to an already processed bucket.
+    std::vector<int> expanded_round(vertices, -1);
+    std::vector<char> pending(threads, 0);
+
+    // Whether thread t has vertices in the bucket that 'slot' currently stands for. Outdated entries are
+    // removed when there is none.
+    const auto has_pending = [&](int t, long long current, int slot) {
+        for (const int vertex: buckets[t][slot]) {
+            if (bucket_of(dist[vertex]) == current) { return true; }
+        }
+        buckets[t][slot].clear();
+        return false;
+    };
+    const auto relax_requests = [&](int owner) {
+        for (int t = 0; t < threads; ++t) {
+            for (const auto &r: requests[t][owner]) {
+                if (r.distance < dist[r.vertex]) {
+                    dist[r.vertex] = r.distance;
+                    parent[r.vertex] = r.parent;
+                    buckets[owner][bucket_of(r.distance) % bucket_count].push_back(r.vertex);
+                }
+            }
+            requests[t][owner].clear();
+        }
+    };
+
+    // The search is over once a whole turn of the circular array has found only empty buckets.
+    for (long long current = 0, empty_buckets = 0; empty_buckets < bucket_count; ++current) {
+        const int slot = static_cast<int>(current % bucket_count);
+        bool any_pending = false;
+        for (int t = 0; t < threads; ++t) {
+            pending[t] = has_pending(t, current, slot);
+            any_pending = any_pending || pending[t];
+        }
+        if (!any_pending) {
+            ++empty_buckets;
+            continue;
+        }
+        empty_buckets = 0;
+        for (int round = 0; any_pending; ++round) {
+            // Expand the vertices of the current bucket through their light edges.
+            pool.run([&](int t) {
+                std::vector<int> frontier;
+                frontier.swap(buckets[t][slot]);
+                for (const int vertex: frontier) {
+                    if (bucket_of(dist[vertex]) != current || expanded_round[vertex] == round) { continue; }
+                    if (expanded_round[vertex] == -1) { settled[t].push_back(vertex); }
+                    expanded_round[vertex] = round;
+                    for (const auto edge: graph.adj_list(vertex)) {
+                        if (edge.cost > delta) { continue; }
+                        requests[t][edge.to % threads].push_back({edge.to, vertex, dist[vertex] + edge.cost});
+                    }
+                }
+            });
+            pool.run([&](int t) {
+                relax_requests(t);
+                pending[t] = has_pending(t, current, slot);
+            });
+            any_pending = std::find(pending.begin(), pending.end(), 1) != pending.end();
+        }
+        // The bucket can't receive more vertices, relax the heavy edges of all the vertices expanded in it.
+        pool.run([&](int t) {
+            for (const int vertex: settled[t]) {
+                for (const auto edge: graph.adj_list(vertex)) {
+                    if (edge.cost <= delta) { continue; }
+                    requests[t][edge.to % threads].push_back({edge.to, vertex, dist[vertex] + edge.cost});
+                }
+            }
+            settled[t].clear();
+        });
+        pool.run(relax_requests);
+    }
+
+    return {src_vertex, dist, parent};
+}
+
+void display_shortest_path(const delta_stepping_result &result, int dest_vertex) {
+    std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
+              << std::setw(4) << result.dist[dest_vertex] << "] ";
+    if (result.dist[dest_vertex] == POSITIVE_INFINITY) {
+        std::cout << "[unreachable]";
+    } else {
+        std::vector<int> path;
+        for (int at = dest_vertex; at != -1; at = result.parent[at]) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+        std::cout << "[" << path[0];
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            std::cout << " -> " << path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+void display_all_shortest_paths(const delta_stepping_result &result) {
+    const int vertices = static_cast<int>(result.dist.size());
+    for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
+        display_shortest_path(result, dest_vertex);
+    }
+}
+
+int main() {
+    thread_pool pool(4);
+    std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
+    {
+        const csr_graph g(6, {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        });
+        const delta_stepping_result result = delta_stepping(g, 0, 3, pool);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 2" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const delta_stepping_result result = delta_stepping(g, 1, 3, pool);
+        display_all_shortest_paths(result);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../priority_queues.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+
+struct dijkstra_pair_result {
+    const int src_vertex, dest_vertex;
+    const double dist;
+    // Vertices of the shortest path from 'src_vertex' to 'dest_vertex', empty if it is unreachable.
+    const std::vector<int> path;
+};
+
+// Bidirectional Dijkstra for Single Pair Shortest Path (SPSP) queries. A forward search from 'src_vertex' on
+// 'graph' and a backward search from 'dest_vertex' on 'reverse_graph' (which must be 'graph.reversed()') run
+// alternately, always advancing the one whose next vertex is closer. Every time an edge connects both
+// searches we get a candidate path, and 'best' keeps the shortest one. Once the two smallest keys in the
+// queues add up to 'best' or more, no path through an unsettled vertex can be shorter, so we can stop. Each
+// search only explores a ball of about half the distance, which on road-like graphs settles far fewer
+// vertices than a single Dijkstra stopped at 'dest_vertex'.
+dijkstra_pair_result dijkstra_pair(const csr_graph &graph, const csr_graph &reverse_graph,
+                                   int src_vertex, int dest_vertex) {
+    const int vertices = static_cast<int>(graph.size());
+    // Index 0 is the forward search and index 1 the backward one.
+    const csr_graph *graphs[2] = {&graph, &reverse_graph};
+    std::vector<double> dist[2] = {std::vector<double>(vertices, POSITIVE_INFINITY),
+                                   std::vector<double>(vertices, POSITIVE_INFINITY)};
+    // parent[0][i] is the previous vertex of i in the path from 'src_vertex', and parent[1][i] the next one in
+    // the path to 'dest_vertex'.
+    std::vector<int> parent[2] = {std::vector<int>(vertices, -1), std::vector<int>(vertices, -1)};
+    indexed_dary_heap<4> pq[2] = {indexed_dary_heap<4>(vertices), indexed_dary_heap<4>(vertices)};
+    dist[0][src_vertex] = 0;
+    dist[1][dest_vertex] = 0;
+    pq[0].push(src_vertex, 0);
+    pq[1].push(dest_vertex, 0);
+    double best = src_vertex == dest_vertex ? 0 : POSITIVE_INFINITY;
+    int meeting_vertex = src_vertex == dest_vertex ? src_vertex : -1;
+
+    while (!pq[0].empty() && !pq[1].empty() && pq[0].top_key() + pq[1].top_key() < best) {
+        const int side = pq[0].top_key() <= pq[1].top_key() ? 0 : 1;
+        const int vertex = pq[side].top();
+        pq[side].pop();
+        for (const auto edge: graphs[side]->adj_list(vertex)) {
+            if (dist[side][vertex] + edge.cost < dist[side][edge.to]) {
+                dist[side][edge.to] = dist[side][vertex] + edge.cost;
+                parent[side][edge.to] = vertex;
+                pq[side].push(edge.to, dist[side][edge.to]);
+            }
+            // The edge connects both searches, check the path going through it.
+            if (dist[side][edge.to] + dist[1 - side][edge.to] < best) {
+                best = dist[side][edge.to] + dist[1 - side][edge.to];
+                meeting_vertex = edge.to;
+            }
+        }
+    }
+
+    std::vector<int> path;
+    if (meeting_vertex != -1) {
+        for (int at = meeting_vertex; at != -1; at = parent[0][at]) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+        for (int at = parent[1][meeting_vertex]; at != -1; at = parent[1][at]) {
+            path.push_back(at);
+        }
+    }
+    return {src_vertex, dest_vertex, best, path};
+}
+
+// Convenience overload that builds the reverse graph for a single query. When answering many queries on the
+// same graph, build 'graph.reversed()' once and use the overload above.
+dijkstra_pair_result dijkstra_pair(const csr_graph &graph, int src_vertex, int dest_vertex) {
+    return dijkstra_pair(graph, graph.reversed(), src_vertex, dest_vertex);
+}
+
+void display_shortest_path(const dijkstra_pair_result &result) {
+    std::cout << "From " << result.src_vertex << " to " << result.dest_vertex << ": ["
+              << std::setw(4) << result.dist << "] ";
+    if (result.dist == POSITIVE_INFINITY) {
+        std::cout << "[unreachable]";
+    } else {
+        std::cout << "[" << result.path[0];
+        for (std::size_t i = 1; i < result.path.size(); ++i) {
+            std::cout << " -> " << result.path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+void display_all_shortest_paths(const csr_graph &graph, int src_vertex) {
+    const csr_graph reverse_graph = graph.reversed();
+    const int vertices = static_cast<int>(graph.size());
+    for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
+        display_shortest_path(dijkstra_pair(graph, reverse_graph, src_vertex, dest_vertex));
+    }
+}
+
+int main() {
+    std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
+    {
+        const csr_graph g(6, {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        });
+        display_all_shortest_paths(g, 0);
+    }
+    std::cout << "Example 2" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        display_all_shortest_paths(g, 1);
+    }
+    return 0;
+}
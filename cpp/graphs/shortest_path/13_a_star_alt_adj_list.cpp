@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../graph_file.h"
+#include "../priority_queues.h"
+#include "../temporary_file.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t ALT_FILE_MAGIC = 0x31544c41;  // "ALT1" in little endian.
+
+struct a_star_result {
+    const int src_vertex, dest_vertex;
+    const double dist;
+    // Vertices of the shortest path from 'src_vertex' to 'dest_vertex', empty if it is unreachable.
+    const std::vector<int> path;
+    // Number of vertices taken out of the queue, a measure of how well the heuristic guides the search.
+    const int settled;
+};
+
+// A* search for Single Pair Shortest Path (SPSP) queries. It works like Dijkstra, but the queue is ordered by
+// dist[v] + heuristic(v), where 'heuristic(v)' is a lower bound of the distance from v to 'dest_vertex'. The
+// better the bound, the more the search is pulled towards the destination and the fewer vertices it settles.
+// With 'heuristic(v) = 0' it is exactly Dijkstra stopped at 'dest_vertex'. The heuristic must be admissible
+// (never overestimate) for the result to be a shortest path. If it is not also consistent (h(u) <= cost(u, v)
+// + h(v) for every edge), a vertex may be improved after being settled, in which case it is queued again.
+template<typename Heuristic>
+a_star_result a_star(const csr_graph &graph, int src_vertex, int dest_vertex, const Heuristic &heuristic) {
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+    // The heuristic is evaluated once per vertex, NaN means that it has not been evaluated yet.
+    std::vector<double> h(vertices, std::numeric_limits<double>::quiet_NaN());
+    indexed_dary_heap<4> pq(vertices);
+    h[src_vertex] = heuristic(src_vertex);
+    pq.push(src_vertex, h[src_vertex]);
+    int settled = 0;
+
+    while (!pq.empty()) {
+        const int vertex = pq.top();
+        pq.pop();
+        ++settled;
+        if (vertex == dest_vertex) { break; }
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (dist[vertex] + edge.cost < dist[edge.to]) {
+                dist[edge.to] = dist[vertex] + edge.cost;
+                parent[edge.to] = vertex;
+                if (std::isnan(h[edge.to])) { h[edge.to] = heuristic(edge.to); }
+                // An infinite bound means that 'dest_vertex' can't be reached from 'edge.to'.
+                if (h[edge.to] != POSITIVE_INFINITY) { pq.push(edge.to, dist[edge.to] + h[edge.to]); }
+            }
+        }
+    }
+
+    std::vector<int> path;
+    if (dist[dest_vertex] != POSITIVE_INFINITY) {
+        for (int at = dest_vertex; at != -1; at = parent[at]) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+    }
+    return {src_vertex, dest_vertex, dist[dest_vertex], path, settled};
+}
+
+// Plain Dijkstra computing the distances from 'src_vertex' to every vertex, used for preprocessing.
+std::vector<double> dijkstra_distances(const csr_graph &graph, int src_vertex) {
+    std::vector<double> dist(graph.size(), POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    indexed_dary_heap<4> pq(static_cast<int>(graph.size()));
+    pq.push(src_vertex, 0);
+    while (!pq.empty()) {
+        const int vertex = pq.top();
+        pq.pop();
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (dist[vertex] + edge.cost < dist[edge.to]) {
+                dist[edge.to] = dist[vertex] + edge.cost;
+                pq.push(edge.to, dist[edge.to]);
+            }
+        }
+    }
+    return dist;
+}
+
+// ALT (A*, Landmarks and Triangle inequality, Goldberg & Harrelson, 2005) preprocessing. For a few landmark
+// vertices L we store d(L, v) and d(v, L) for every vertex v, and the triangle inequality gives two lower
+// bounds of d(v, t) for any target t:
+//   d(v, t) >= d(v, L) - d(t, L)   and   d(v, t) >= d(L, t) - d(L, v).
+// The heuristic is the best of these bounds over all the landmarks, which is admissible and consistent.
+// Landmarks work best on the periphery of the graph, 'behind' the vertices from the point of view of the
+// queries, so they are picked with the farthest-first strategy.
+class alt_landmarks {
+private:
+    int vertices = 0;
+    std::vector<int> landmarks;
+    // Vertex-major tables, the K distances of a vertex are contiguous: from[v * K + i] = d(landmarks[i], v)
+    // and to[v * K + i] = d(v, landmarks[i]).
+    std::vector<double> from, to;
+
+    alt_landmarks() = default;
+public:
+    // Picks 'count' landmarks and computes their tables with 2 Dijkstra runs per landmark. The first landmark
+    // is the vertex farthest from 'first_vertex', and every following one is the vertex farthest from the
+    // landmarks already chosen (distances measured in both directions, ignoring unreachable vertices).
+    alt_landmarks(const csr_graph &graph, int count, int first_vertex = 0)
+            : vertices(static_cast<int>(graph.size())) {
+        const csr_graph reverse_graph = graph.reversed();
+        count = std::min(count, vertices);
+        from.assign(static_cast<std::size_t>(vertices) * count, POSITIVE_INFINITY);
+        to.assign(static_cast<std::size_t>(vertices) * count, POSITIVE_INFINITY);
+        // closeness[v] is the smallest distance from v to the landmarks chosen so far.
+        std::vector<double> closeness(vertices, POSITIVE_INFINITY);
+        const std::vector<double> first_dist = dijkstra_distances(graph, first_vertex);
+        std::vector<bool> chosen(vertices, false);
+        int next = first_vertex;
+        for (int v = 0; v < vertices; ++v) {
+            if (first_dist[v] != POSITIVE_INFINITY && first_dist[v] > first_dist[next]) { next = v; }
+        }
+        for (int i = 0; i < count; ++i) {
+            landmarks.push_back(next);
+            chosen[next] = true;
+            const std::vector<double> dist_from = dijkstra_distances(graph, next);
+            const std::vector<double> dist_to = dijkstra_distances(reverse_graph, next);
+            for (int v = 0; v < vertices; ++v) {
+                from[static_cast<std::size_t>(v) * count + i] = dist_from[v];
+                to[static_cast<std::size_t>(v) * count + i] = dist_to[v];
+                closeness[v] = std::min({closeness[v], dist_from[v], dist_to[v]});
+            }
+            // Prefer the farthest vertex reachable from/to some landmark, or any unchosen vertex otherwise.
+            next = -1;
+            for (int v = 0; v < vertices; ++v) {
+                if (chosen[v]) { continue; }
+                if (next == -1 || (closeness[v] != POSITIVE_INFINITY &&
+                                   (closeness[next] == POSITIVE_INFINITY || closeness[v] > closeness[next]))) {
+                    next = v;
+                }
+            }
+        }
+    }
+    std::size_t size() const { return vertices; }
+    const std::vector<int> &landmark_vertices() const { return landmarks; }
+
+    // Lower bound of d(vertex, dest_vertex). Bounds involving an infinite distance are skipped, except that if
+    // 'vertex' can't reach a landmark that 'dest_vertex' reaches, it can't reach 'dest_vertex' either.
+    double lower_bound(int vertex, int dest_vertex) const {
+        const std::size_t count = landmarks.size();
+        const double *from_v = from.data() + vertex * count, *from_t = from.data() + dest_vertex * count;
+        const double *to_v = to.data() + vertex * count, *to_t = to.data() + dest_vertex * count;
+        double bound = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (to_t[i] != POSITIVE_INFINITY) {
+                if (to_v[i] == POSITIVE_INFINITY) { return POSITIVE_INFINITY; }
+                bound = std::max(bound, to_v[i] - to_t[i]);
+            }
+            if (from_v[i] != POSITIVE_INFINITY && from_t[i] != POSITIVE_INFINITY) {
+                bound = std::max(bound, from_t[i] - from_v[i]);
+            }
+        }
+        return bound;
+    }
+    // Heuristic for 'a_star' towards 'dest_vertex'.
+    class heuristic {
+    private:
+        const alt_landmarks &landmarks;
+        const int dest_vertex;
+    public:
+        heuristic(const alt_landmarks &landmarks, int dest_vertex) : landmarks(landmarks), dest_vertex(dest_vertex) {}
+        double operator()(int vertex) const { return landmarks.lower_bound(vertex, dest_vertex); }
+    };
+    heuristic towards(int dest_vertex) const { return {*this, dest_vertex}; }
+
+    // Binary format: magic "ALT1", V and K as 32-bit integers, the K landmarks as 32-bit integers, then the
+    // 'from' and 'to' tables as 64-bit doubles (V * K each), all in the byte order of the machine. Query
+    // servers can load the tables instead of repeating the 2K Dijkstra runs.
+    void save(std::ostream &out) const {
+        const std::uint32_t header[3] = {ALT_FILE_MAGIC, static_cast<std::uint32_t>(vertices),
+                                         static_cast<std::uint32_t>(landmarks.size())};
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        for (const int landmark: landmarks) {
+            const std::uint32_t value = landmark;
+            out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+        out.write(reinterpret_cast<const char *>(from.data()), static_cast<std::streamsize>(from.size() * sizeof(double)));
+        out.write(reinterpret_cast<const char *>(to.data()), static_cast<std::streamsize>(to.size() * sizeof(double)));
+        if (!out) { throw std::runtime_error("alt_landmarks: write failed"); }
+    }
+    // Loads tables saved for a graph of 'vertices' vertices, the one they will be used with. The header is
+    // checked against that graph and against the bytes left in the stream before anything is allocated, and a
+    // stream that can't tell its length is read in chunks, so a foreign or corrupted file can't trigger a huge
+    // allocation nor make 'lower_bound' read past the tables.
+    static alt_landmarks load(std::istream &in, std::size_t vertices) {
+        std::uint32_t header[3];
+        if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != ALT_FILE_MAGIC) {
+            throw std::runtime_error("alt_landmarks: not a landmarks file");
+        }
+        if (header[1] >= static_cast<std::uint32_t>(std::numeric_limits<int>::max()) || header[1] != vertices) {
+            throw std::runtime_error("alt_landmarks: the tables are for a graph with another number of vertices");
+        }
+        if (header[2] > header[1]) { throw std::runtime_error("alt_landmarks: more landmarks than vertices"); }
+        const std::size_t count = header[2];
+        // K landmarks and two V x K tables, at most 4 + 16 * 2^31 bytes per landmark, so this can't overflow.
+        const std::uint64_t expected_bytes = count * sizeof(std::uint32_t) + 2 * count * vertices * sizeof(double);
+        const std::istream::pos_type position = in.tellg();
+        if (position != std::istream::pos_type(-1)) {
+            in.seekg(0, std::ios::end);
+            const std::uint64_t left = static_cast<std::uint64_t>(in.tellg() - position);
+            in.seekg(position);
+            if (!in || left < expected_bytes) { throw std::runtime_error("alt_landmarks: truncated landmarks file"); }
+        }
+        // Reads 'size' values in chunks of at most 2^20, growing 'values' only as they arrive.
+        const auto read_values = [&in](auto &values, std::size_t size) {
+            constexpr std::size_t CHUNK = std::size_t{1} << 20;
+            for (std::size_t read = 0; read < size;) {
+                const std::size_t chunk = std::min(CHUNK, size - read);
+                values.resize(read + chunk);
+                if (!in.read(reinterpret_cast<char *>(values.data() + read),
+                             static_cast<std::streamsize>(chunk * sizeof(values[0])))) {
+                    throw std::runtime_error("alt_landmarks: truncated landmarks file");
+                }
+                read += chunk;
+            }
+        };
+        alt_landmarks result;
+        result.vertices = static_cast<int>(header[1]);
+        std::vector<std::uint32_t> landmarks;
+        read_values(landmarks, count);
+        for (const std::uint32_t landmark: landmarks) {
+            if (landmark >= header[1]) { throw std::runtime_error("alt_landmarks: landmark out of range"); }
+        }
+        result.landmarks.assign(landmarks.begin(), landmarks.end());
+        read_values(result.from, count * vertices);
+        read_values(result.to, count * vertices);
+        return result;
+    }
+};
+
+void display_shortest_path(const a_star_result &result) {
+    std::cout << "From " << result.src_vertex << " to " << result.dest_vertex << ": ["
+              << std::setw(4) << result.dist << "] ";
+    if (result.dist == POSITIVE_INFINITY) {
+        std::cout << "[unreachable]";
+    } else {
+        std::cout << "[" << result.path[0];
+        for (std::size_t i = 1; i < result.path.size(); ++i) {
+            std::cout << " -> " << result.path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << " (settled " << result.settled << ")" << std::endl;
+}
+
+// A rows x columns grid where every vertex has edges to its 4 neighbors, with costs between 1 and 5.
+csr_graph make_grid_graph(int rows, int columns) {
+    std::vector<edge> edges;
+    const int moves[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            for (const auto &move: moves) {
+                const int nr = r + move[0], nc = c + move[1];
+                if (nr < 0 || nr >= rows || nc < 0 || nc >= columns) { continue; }
+                edges.push_back({r * columns + c, nr * columns + nc, static_cast<double>(1 + (r * 7 + c * 13) % 5)});
+            }
+        }
+    }
+    return {rows * columns, edges};
+}
+
+int main() {
+    const auto no_heuristic = [](int) { return 0.0; };
+    std::cout << "Example 1" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        // Preprocess once, store the tables and load them back, as a query server would do on startup.
+        std::stringstream file;
+        alt_landmarks(g, 2).save(file);
+        const alt_landmarks landmarks = alt_landmarks::load(file, g.size());
+        for (int dest_vertex = 0; dest_vertex < 12; ++dest_vertex) {
+            display_shortest_path(a_star(g, 1, dest_vertex, landmarks.towards(dest_vertex)));
+        }
+    }
+    std::cout << "Example 2" << std::endl;  // 100 x 100 grid, between two vertices far from the landmarks.
+    {
+        const csr_graph g = make_grid_graph(100, 100);
+        const alt_landmarks landmarks(g, 4);
+        const a_star_result dijkstra_result = a_star(g, 2510, 7489, no_heuristic);
+        const a_star_result alt_result = a_star(g, 2510, 7489, landmarks.towards(7489));
+        std::cout << "Dijkstra: [" << dijkstra_result.dist << "] (settled " << dijkstra_result.settled << ")" << std::endl;
+        std::cout << "ALT:      [" << alt_result.dist << "] (settled " << alt_result.settled << ")" << std::endl;
+    }
+    std::cout << "Example 3" << std::endl;  // 100 x 100 grid stored in a graph file with the coordinates.
+    {
+        std::vector<double> coords;
+        for (int v = 0; v < 100 * 100; ++v) {
+            coords.push_back(v % 100);
+            coords.push_back(v / 100);
+        }
+        const temporary_file file(".csrg");
+        {
+            std::ofstream out(file.path(), std::ios::binary);
+            write_graph_file(out, make_grid_graph(100, 100), coords);
+        }
+        // The mapping keeps the contents alive after the file is removed.
+        const mapped_graph mapped = map_graph_file(file.path());
+        // Every edge costs at least 1, so the Manhattan distance on the grid is a lower bound.
+        const auto manhattan = [&](int dest_vertex) {
+            return [&mapped, dest_vertex](int v) {
+                return std::abs(mapped.coords[2 * v] - mapped.coords[2 * dest_vertex])
+                       + std::abs(mapped.coords[2 * v + 1] - mapped.coords[2 * dest_vertex + 1]);
+            };
+        };
+        const a_star_result result = a_star(mapped.graph, 2510, 7489, manhattan(7489));
+        std::cout << "Manhattan: [" << result.dist << "] (settled " << result.settled << ")" << std::endl;
+    }
+    return 0;
+}
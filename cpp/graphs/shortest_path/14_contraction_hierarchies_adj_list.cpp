@@ -0,0 +1,663 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../priority_queues.h"
+#include "../stamped_array.h"
+#include "../thread_pool.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t CH_FILE_MAGIC = 0x31304843;  // "CH01" in little endian.
+// A witness search gives up after settling this many vertices, and the shortcut is added just in case. The
+// searches that only estimate the priority of a vertex use a smaller limit.
+constexpr int WITNESS_SETTLE_LIMIT = 500;
+constexpr int SIMULATION_SETTLE_LIMIT = 50;
+
+// Contraction Hierarchies (Geisberger, Sanders, Schultes & Delling, 2008). Preprocessing 'contracts' the
+// vertices one by one from the least to the most important: the vertex is removed from the graph, and for
+// every pair of neighbors u -> v -> w whose only shortest path goes through v, a 'shortcut' edge u -> w is
+// added with the cost of that path. The position of a vertex in that order is its 'rank'. In the resulting
+// graph (original edges plus shortcuts) there is always a shortest path that first goes up in rank and then
+// down, so a query only needs a forward search on the edges going up from the source, and a backward search
+// on the edges coming down to the destination. Both searches are tiny compared to Dijkstra's, and the
+// shortcuts of the result are unpacked into original edges at the end.
+class contraction_hierarchy {
+public:
+    // Edge of the search graphs. 'middle' is the contracted vertex a shortcut skips, or -1 for original edges.
+    struct arc {
+        double cost;
+        int to;
+        int middle;
+    };
+private:
+    int vertices = 0;
+    std::vector<int> rank;
+    // CSR upward graph: the edges u -> w with rank[u] < rank[w] stored at u.
+    std::vector<int> up_offsets;
+    std::vector<arc> up_arcs;
+    // CSR downward graph, reversed: the edges u -> w with rank[u] > rank[w] stored at w, pointing to u.
+    std::vector<int> down_offsets;
+    std::vector<arc> down_arcs;
+
+    contraction_hierarchy() = default;
+
+    // Remaining (not yet contracted) graph used during preprocessing, where every vertex knows its outgoing
+    // and incoming edges.
+    class builder {
+    public:
+        std::vector<std::vector<arc>> out, in;
+        // Number of neighbors already contracted, which spreads the contraction uniformly over the graph.
+        std::vector<int> deleted_neighbors;
+    private:
+        // Witness search state, reset after every search by walking the touched vertices.
+        std::vector<double> witness_dist;
+        std::vector<int> touched;
+        indexed_dary_heap<4> pq;
+        // target_of[v] == search_id marks the vertices the current witness search is looking for.
+        std::vector<int> target_of;
+        int search_id = 0;
+    public:
+        explicit builder(const csr_graph &graph)
+                : out(graph.size()), in(graph.size()), deleted_neighbors(graph.size(), 0), witness_dist(graph.size(), POSITIVE_INFINITY),
+                  pq(static_cast<int>(graph.size())), target_of(graph.size(), 0) {
+            for (int vertex = 0; vertex < static_cast<int>(graph.size()); ++vertex) {
+                for (const auto edge: graph.adj_list(vertex)) {
+                    assert(edge.cost >= 0);
+                    // Self loops are never part of a shortest path.
+                    if (edge.to != vertex) { add_edge(vertex, edge.to, edge.cost, -1); }
+                }
+            }
+        }
+        // Adds the edge 'from' -> 'to', or lowers the cost of the existing one (parallel edges are merged).
+        void add_edge(int from, int to, double cost, int middle) {
+            for (auto &a: out[from]) {
+                if (a.to != to) { continue; }
+                if (cost < a.cost) {
+                    a = {cost, to, middle};
+                    for (auto &b: in[to]) {
+                        if (b.to == from) { b = {cost, from, middle}; }
+                    }
+                }
+                return;
+            }
+            out[from].push_back({cost, to, middle});
+            in[to].push_back({cost, from, middle});
+        }
+        // Limited Dijkstra from 'src_vertex' that ignores 'excluded_vertex' (the one being contracted), and
+        // stops once every out-neighbor of 'excluded_vertex' is settled, the distances go beyond 'max_cost' or
+        // 'settle_limit' vertices are settled. Leaves its results in 'witness_dist'.
+        void witness_search(int src_vertex, int excluded_vertex, double max_cost, int settle_limit) {
+            for (const int vertex: touched) { witness_dist[vertex] = POSITIVE_INFINITY; }
+            touched.clear();
+            pq.clear();
+            ++search_id;
+            int targets = 0;
+            for (const auto &a: out[excluded_vertex]) {
+                if (a.to != src_vertex && target_of[a.to] != search_id) {
+                    target_of[a.to] = search_id;
+                    ++targets;
+                }
+            }
+            witness_dist[src_vertex] = 0;
+            touched.push_back(src_vertex);
+            pq.push(src_vertex, 0);
+            for (int settled = 0; targets > 0 && !pq.empty() && pq.top_key() <= max_cost && settled < settle_limit;
+                 ++settled) {
+                const int vertex = pq.top();
+                pq.pop();
+                if (target_of[vertex] == search_id) { --targets; }
+                for (const auto &a: out[vertex]) {
+                    if (a.to == excluded_vertex || witness_dist[vertex] + a.cost >= witness_dist[a.to]) { continue; }
+                    if (witness_dist[a.to] == POSITIVE_INFINITY) { touched.push_back(a.to); }
+                    witness_dist[a.to] = witness_dist[vertex] + a.cost;
+                    pq.push(a.to, witness_dist[a.to]);
+                }
+            }
+        }
+        // Returns how many shortcuts contracting 'vertex' needs, and adds them unless 'simulate' is set.
+        int contract(int vertex, bool simulate) {
+            int shortcuts = 0;
+            for (const auto &in_arc: in[vertex]) {
+                double max_cost = 0;
+                for (const auto &out_arc: out[vertex]) {
+                    if (out_arc.to != in_arc.to) { max_cost = std::max(max_cost, in_arc.cost + out_arc.cost); }
+                }
+                witness_search(in_arc.to, vertex, max_cost, simulate ? SIMULATION_SETTLE_LIMIT : WITNESS_SETTLE_LIMIT);
+                for (const auto &out_arc: out[vertex]) {
+                    if (out_arc.to == in_arc.to || witness_dist[out_arc.to] <= in_arc.cost + out_arc.cost) {
+                        continue;
+                    }
+                    ++shortcuts;
+                    if (!simulate) { add_edge(in_arc.to, out_arc.to, in_arc.cost + out_arc.cost, vertex); }
+                }
+            }
+            return shortcuts;
+        }
+        // Edge difference: the edges that contracting the vertex adds minus the ones it removes. Vertices that
+        // don't make the graph denser are contracted first.
+        double priority(int vertex) {
+            const int removed_edges = static_cast<int>(in[vertex].size() + out[vertex].size());
+            return contract(vertex, true) - removed_edges + deleted_neighbors[vertex];
+        }
+        // Removes 'vertex' from the remaining graph.
+        void remove(int vertex) {
+            for (const auto &a: in[vertex]) {
+                auto &list = out[a.to];
+                list.erase(std::remove_if(list.begin(), list.end(), [&](const arc &b) { return b.to == vertex; }),
+                           list.end());
+                ++deleted_neighbors[a.to];
+            }
+            for (const auto &a: out[vertex]) {
+                auto &list = in[a.to];
+                list.erase(std::remove_if(list.begin(), list.end(), [&](const arc &b) { return b.to == vertex; }),
+                           list.end());
+                ++deleted_neighbors[a.to];
+            }
+        }
+    };
+
+    static void build_csr(const std::vector<std::vector<arc>> &lists, std::vector<int> &offsets,
+                          std::vector<arc> &arcs) {
+        offsets.assign(1, 0);
+        arcs.clear();
+        for (const auto &list: lists) {
+            arcs.insert(arcs.end(), list.begin(), list.end());
+            offsets.push_back(static_cast<int>(arcs.size()));
+        }
+    }
+    template<typename T>
+    static void write_vector(std::ostream &out, const std::vector<T> &values) {
+        const std::uint64_t size = values.size();
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+    }
+    // Reads a vector written by 'write_vector'. The element count comes from the file, so it is checked
+    // against the bytes left in the stream before anything is allocated, and a stream that can't tell its
+    // length is read in chunks, so that memory only grows as the data actually arrives.
+    template<typename T>
+    static void read_vector(std::istream &in, std::vector<T> &values) {
+        const auto corrupt = [] {
+            return std::runtime_error("contraction_hierarchy: truncated or corrupt hierarchy file");
+        };
+        std::uint64_t size = 0;
+        if (!in.read(reinterpret_cast<char *>(&size), sizeof(size))) { throw corrupt(); }
+        const std::istream::pos_type position = in.tellg();
+        if (position != std::istream::pos_type(-1)) {
+            in.seekg(0, std::ios::end);
+            const std::uint64_t left = static_cast<std::uint64_t>(in.tellg() - position);
+            in.seekg(position);
+            if (!in || size > left / sizeof(T)) { throw corrupt(); }
+        }
+        constexpr std::uint64_t CHUNK = std::uint64_t{1} << 20;
+        values.clear();
+        for (std::uint64_t read = 0; read < size;) {
+            const std::uint64_t count = std::min(CHUNK, size - read);
+            values.resize(read + count);
+            if (!in.read(reinterpret_cast<char *>(values.data() + read),
+                         static_cast<std::streamsize>(count * sizeof(T)))) {
+                throw corrupt();
+            }
+            read += count;
+        }
+    }
+    // Whether 'offsets' and 'arcs' form a valid CSR graph of the hierarchy: offsets non-decreasing from 0 to the
+    // number of arcs, and every arc of a vertex going to a vertex of higher rank ('to' in [0, V)) through a
+    // vertex of lower rank than both ('middle' in [0, V), or -1 for an original edge), with a non-negative cost.
+    bool valid_graph(const std::vector<int> &offsets, const std::vector<arc> &arcs) const {
+        if (offsets.size() != static_cast<std::size_t>(vertices) + 1 || offsets[0] != 0
+            || static_cast<std::size_t>(offsets.back()) != arcs.size()) {
+            return false;
+        }
+        for (int v = 0; v < vertices; ++v) {
+            if (offsets[v] > offsets[v + 1]) { return false; }
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                const arc &a = arcs[i];
+                if (a.to < 0 || a.to >= vertices || rank[a.to] <= rank[v] || !(a.cost >= 0)) { return false; }
+                if (a.middle != -1 && (a.middle < 0 || a.middle >= vertices || rank[a.middle] >= rank[v])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    // Whether both halves of every shortcut are in the hierarchy, so that 'unpack' always finds them.
+    bool valid_shortcuts(const std::vector<int> &offsets, const std::vector<arc> &arcs, bool up) const {
+        for (int v = 0; v < vertices; ++v) {
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                if (arcs[i].middle == -1) { continue; }
+                // The shortcut from -> to, where 'v' is 'from' in the upward graph and 'to' in the downward one.
+                const int from = up ? v : arcs[i].to, to = up ? arcs[i].to : v, middle = arcs[i].middle;
+                if (std::find_if(down_begin(middle), down_end(middle), [&](const arc &a) { return a.to == from; })
+                    == down_end(middle)
+                    || std::find_if(up_begin(middle), up_end(middle), [&](const arc &a) { return a.to == to; })
+                       == up_end(middle)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+public:
+    // Preprocessing. Vertices are kept in a queue ordered by priority, which is updated lazily: the top vertex
+    // is only contracted if its recomputed priority is still the smallest, otherwise it goes back to the queue.
+    // Eagerly recomputing the priorities of the neighbors of every contracted vertex gives a similar order, but
+    // multiplies the number of witness searches.
+    explicit contraction_hierarchy(const csr_graph &graph)
+            : vertices(static_cast<int>(graph.size())), rank(graph.size(), -1) {
+        builder b(graph);
+        std::vector<std::vector<arc>> up(vertices), down(vertices);
+        indexed_dary_heap<4> order(vertices);
+        for (int vertex = 0; vertex < vertices; ++vertex) {
+            order.push(vertex, b.priority(vertex));
+        }
+        for (int next_rank = 0; !order.empty();) {
+            const int vertex = order.top();
+            order.pop();
+            const double priority = b.priority(vertex);
+            if (!order.empty() && priority > order.top_key()) {
+                order.push(vertex, priority);
+                continue;
+            }
+            b.contract(vertex, false);
+            rank[vertex] = next_rank++;
+            // All the remaining neighbors have a higher rank, so these edges are final.
+            up[vertex] = b.out[vertex];
+            down[vertex] = b.in[vertex];
+            b.remove(vertex);
+        }
+        build_csr(up, up_offsets, up_arcs);
+        build_csr(down, down_offsets, down_arcs);
+    }
+    std::size_t size() const { return vertices; }
+    std::size_t shortcut_count() const {
+        std::size_t count = 0;
+        for (const auto &a: up_arcs) { count += a.middle != -1; }
+        for (const auto &a: down_arcs) { count += a.middle != -1; }
+        return count;
+    }
+    int vertex_rank(int vertex) const { return rank[vertex]; }
+    const arc *up_begin(int vertex) const { return up_arcs.data() + up_offsets[vertex]; }
+    const arc *up_end(int vertex) const { return up_arcs.data() + up_offsets[vertex + 1]; }
+    const arc *down_begin(int vertex) const { return down_arcs.data() + down_offsets[vertex]; }
+    const arc *down_end(int vertex) const { return down_arcs.data() + down_offsets[vertex + 1]; }
+
+    // Appends to 'path' the original vertices after 'from' on the edge 'from' -> 'to'. A shortcut through
+    // 'middle' stands for the edges 'from' -> 'middle' (stored reversed in the downward graph at 'middle',
+    // since 'middle' has the lowest rank) and 'middle' -> 'to' (stored in the upward graph at 'middle').
+    void unpack(int from, int to, int middle, std::vector<int> &path) const {
+        if (middle == -1) {
+            path.push_back(to);
+            return;
+        }
+        const arc *first = std::find_if(down_begin(middle), down_end(middle), [&](const arc &a) { return a.to == from; });
+        const arc *second = std::find_if(up_begin(middle), up_end(middle), [&](const arc &a) { return a.to == to; });
+        assert(first != down_end(middle) && second != up_end(middle));
+        unpack(from, middle, first->middle, path);
+        unpack(middle, to, second->middle, path);
+    }
+
+    // Binary format: magic "CH01", V as a 32-bit integer, then 'rank', 'up_offsets', 'up_arcs', 'down_offsets'
+    // and 'down_arcs', each one as a 64-bit element count followed by the raw elements, all in the byte order
+    // of the machine. Preprocessing takes minutes on large graphs, while loading is a few sequential reads.
+    void save(std::ostream &out) const {
+        const std::uint32_t header[2] = {CH_FILE_MAGIC, static_cast<std::uint32_t>(vertices)};
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        write_vector(out, rank);
+        write_vector(out, up_offsets);
+        write_vector(out, up_arcs);
+        write_vector(out, down_offsets);
+        write_vector(out, down_arcs);
+        if (!out) { throw std::runtime_error("contraction_hierarchy: write failed"); }
+    }
+    // Loads a hierarchy saved for a graph of 'vertices' vertices, the one it will be used with. Everything the
+    // queries index with is checked (offsets, targets and middles of the arcs, and 'rank' being a permutation
+    // consistent with them), so a foreign or corrupted file is rejected instead of making a query read out of
+    // bounds.
+    static contraction_hierarchy load(std::istream &in, std::size_t vertices) {
+        std::uint32_t header[2];
+        if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != CH_FILE_MAGIC) {
+            throw std::runtime_error("contraction_hierarchy: not a hierarchy file");
+        }
+        if (header[1] >= static_cast<std::uint32_t>(std::numeric_limits<int>::max()) || header[1] != vertices) {
+            throw std::runtime_error("contraction_hierarchy: the hierarchy is for a graph with another number of "
+                                     "vertices");
+        }
+        contraction_hierarchy result;
+        result.vertices = static_cast<int>(header[1]);
+        read_vector(in, result.rank);
+        read_vector(in, result.up_offsets);
+        read_vector(in, result.up_arcs);
+        read_vector(in, result.down_offsets);
+        read_vector(in, result.down_arcs);
+        bool valid = result.rank.size() == vertices;
+        std::vector<bool> seen(vertices, false);
+        for (std::size_t v = 0; valid && v < vertices; ++v) {
+            const int r = result.rank[v];
+            valid = r >= 0 && r < result.vertices && !seen[r];
+            if (valid) { seen[r] = true; }
+        }
+        valid = valid && result.valid_graph(result.up_offsets, result.up_arcs)
+                && result.valid_graph(result.down_offsets, result.down_arcs)
+                && result.valid_shortcuts(result.up_offsets, result.up_arcs, true)
+                && result.valid_shortcuts(result.down_offsets, result.down_arcs, false);
+        if (!valid) { throw std::runtime_error("contraction_hierarchy: truncated or corrupt hierarchy file"); }
+        return result;
+    }
+};
+
+struct ch_result {
+    const int src_vertex, dest_vertex;
+    const double dist;
+    // Vertices of the shortest path from 'src_vertex' to 'dest_vertex', empty if it is unreachable.
+    const std::vector<int> path;
+    // Number of vertices taken out of both queues.
+    const int settled;
+};
+
+// Query engine for a 'contraction_hierarchy'. It keeps its search state between queries and only resets the
+// vertices touched by the previous one, so a query costs time proportional to the (small) search spaces
+// instead of O(V). Each thread answering queries needs its own 'ch_query'.
+class ch_query {
+private:
+    const contraction_hierarchy &ch;
+    // Index 0 is the forward search and index 1 the backward one.
+    std::vector<double> dist[2];
+    std::vector<int> parent[2], parent_middle[2];
+    std::vector<int> touched;
+    indexed_dary_heap<4> pq[2];
+public:
+    explicit ch_query(const contraction_hierarchy &ch)
+            : ch(ch), dist{std::vector<double>(ch.size(), POSITIVE_INFINITY), std::vector<double>(ch.size(), POSITIVE_INFINITY)},
+              parent{std::vector<int>(ch.size(), -1), std::vector<int>(ch.size(), -1)},
+              parent_middle{std::vector<int>(ch.size(), -1), std::vector<int>(ch.size(), -1)},
+              pq{indexed_dary_heap<4>(static_cast<int>(ch.size())), indexed_dary_heap<4>(static_cast<int>(ch.size()))} {}
+
+    ch_result query(int src_vertex, int dest_vertex) {
+        for (const int vertex: touched) {
+            for (int side = 0; side < 2; ++side) {
+                dist[side][vertex] = POSITIVE_INFINITY;
+                parent[side][vertex] = parent_middle[side][vertex] = -1;
+            }
+        }
+        touched.clear();
+        pq[0].clear();
+        pq[1].clear();
+        dist[0][src_vertex] = 0;
+        dist[1][dest_vertex] = 0;
+        touched.push_back(src_vertex);
+        touched.push_back(dest_vertex);
+        pq[0].push(src_vertex, 0);
+        pq[1].push(dest_vertex, 0);
+        double best = POSITIVE_INFINITY;
+        int meeting_vertex = -1, settled = 0;
+
+        // Unlike bidirectional Dijkstra, each search must continue until its own smallest key reaches 'best',
+        // because the searches only go up and may meet at a vertex of high rank far from both ends.
+        while (true) {
+            const bool forward = !pq[0].empty() && pq[0].top_key() < best;
+            const bool backward = !pq[1].empty() && pq[1].top_key() < best;
+            if (!forward && !backward) { break; }
+            const int side = forward && (!backward || pq[0].top_key() <= pq[1].top_key()) ? 0 : 1;
+            const int vertex = pq[side].top();
+            pq[side].pop();
+            ++settled;
+            if (dist[0][vertex] + dist[1][vertex] < best) {
+                best = dist[0][vertex] + dist[1][vertex];
+                meeting_vertex = vertex;
+            }
+            const auto *first = side == 0 ? ch.up_begin(vertex) : ch.down_begin(vertex);
+            const auto *last = side == 0 ? ch.up_end(vertex) : ch.down_end(vertex);
+            for (const auto *a = first; a != last; ++a) {
+                if (dist[side][vertex] + a->cost >= dist[side][a->to]) { continue; }
+                if (dist[0][a->to] == POSITIVE_INFINITY && dist[1][a->to] == POSITIVE_INFINITY) {
+                    touched.push_back(a->to);
+                }
+                dist[side][a->to] = dist[side][vertex] + a->cost;
+                parent[side][a->to] = vertex;
+                parent_middle[side][a->to] = a->middle;
+                pq[side].push(a->to, dist[side][a->to]);
+            }
+        }
+
+        std::vector<int> path;
+        if (meeting_vertex != -1) {
+            // Up from 'src_vertex' to the meeting vertex.
+            std::vector<int> up_path;
+            for (int at = meeting_vertex; at != -1; at = parent[0][at]) {
+                up_path.push_back(at);
+            }
+            std::reverse(up_path.begin(), up_path.end());
+            path.push_back(src_vertex);
+            for (std::size_t i = 1; i < up_path.size(); ++i) {
+                ch.unpack(up_path[i - 1], up_path[i], parent_middle[0][up_path[i]], path);
+            }
+            // Down from the meeting vertex to 'dest_vertex'.
+            for (int at = meeting_vertex; at != dest_vertex; at = parent[1][at]) {
+                ch.unpack(at, parent[1][at], parent_middle[1][at], path);
+            }
+        }
+        return {src_vertex, dest_vertex, best, path, settled};
+    }
+};
+
+struct distance_table_result {
+    const std::vector<int> src_vertices;
+    const std::vector<int> dest_vertices;
+    // Row-major |src_vertices| x |dest_vertices| matrix, dist[i * |dest_vertices| + j] is the distance from
+    // 'src_vertices[i]' to 'dest_vertices[j]'.
+    const std::vector<double> dist;
+};
+
+// Search state of one thread in 'distance_table', reused by all the searches of that thread.
+struct ch_search_workspace {
+    stamped_array<double> dist;
+    indexed_dary_heap<4> pq;
+    explicit ch_search_workspace(int vertices) : dist(vertices, POSITIVE_INFINITY), pq(vertices) {}
+};
+
+// Complete search from 'vertex' on the upward graph ('forward') or on the downward graph, which calls
+// 'visit(v, d)' for every vertex v it settles at distance d. The distances are only upper bounds, except on
+// the vertices where a shortest up-down path changes direction, which is all a CH query needs.
+template<typename Visit>
+void upward_search(const contraction_hierarchy &ch, int vertex, bool forward, ch_search_workspace &workspace,
+                   const Visit &visit) {
+    workspace.dist.reset();
+    workspace.dist.set(vertex, 0);
+    workspace.pq.push(vertex, 0);
+    while (!workspace.pq.empty()) {
+        const double distance = workspace.pq.top_key();
+        const int at = workspace.pq.top();
+        workspace.pq.pop();
+        visit(at, distance);
+        const auto *first = forward ? ch.up_begin(at) : ch.down_begin(at);
+        const auto *last = forward ? ch.up_end(at) : ch.down_end(at);
+        for (const auto *a = first; a != last; ++a) {
+            if (distance + a->cost < workspace.dist[a->to]) {
+                workspace.dist.set(a->to, distance + a->cost);
+                workspace.pq.push(a->to, distance + a->cost);
+            }
+        }
+    }
+}
+
+// Bucket-based many-to-many (Knopp, Sanders, Schultes, Schulz & Wagner, 2007). A backward upward search from
+// every destination j leaves an entry (j, d) in the 'bucket' of each vertex it settles at distance d. Then a
+// forward upward search from every source scans the buckets of the vertices it settles: the distance to j is
+// the smallest forward distance plus bucket distance among them, since every shortest path has a vertex where
+// it turns from going up to going down. The table costs |S| + |T| small searches instead of |S| Dijkstra runs
+// over the graph. Both phases run in parallel on the threads of 'pool', and every row of the table is filled
+// by a single thread, so the result is the same for any number of threads.
+distance_table_result distance_table(const contraction_hierarchy &ch, const std::vector<int> &src_vertices,
+                                     const std::vector<int> &dest_vertices, thread_pool &pool) {
+    struct bucket_entry {
+        int column;
+        double dist;
+    };
+    const int vertices = static_cast<int>(ch.size());
+    const std::size_t columns = dest_vertices.size();
+    std::vector<ch_search_workspace> workspaces;
+    workspaces.reserve(pool.size());
+    for (int thread_id = 0; thread_id < pool.size(); ++thread_id) {
+        workspaces.emplace_back(vertices);
+    }
+
+    // Backward searches, each one collecting its (vertex, distance) pairs on its own.
+    std::vector<std::vector<std::pair<int, double>>> search_spaces(columns);
+    pool.parallel_for(0, static_cast<long long>(columns), 1, [&](int thread_id, long long j) {
+        upward_search(ch, dest_vertices[j], false, workspaces[thread_id], [&](int vertex, double distance) {
+            search_spaces[j].push_back({vertex, distance});
+        });
+    });
+    // Group the entries by vertex (as in 'csr_graph'), so the buckets of a vertex are contiguous.
+    std::vector<int> bucket_offsets(vertices + 1, 0);
+    for (const auto &search_space: search_spaces) {
+        for (const auto &entry: search_space) { ++bucket_offsets[entry.first + 1]; }
+    }
+    for (int vertex = 0; vertex < vertices; ++vertex) {
+        bucket_offsets[vertex + 1] += bucket_offsets[vertex];
+    }
+    std::vector<bucket_entry> buckets(bucket_offsets.back());
+    std::vector<int> next(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (std::size_t j = 0; j < columns; ++j) {
+        for (const auto &entry: search_spaces[j]) {
+            buckets[next[entry.first]++] = {static_cast<int>(j), entry.second};
+        }
+    }
+
+    // Forward searches, each one filling its own row.
+    std::vector<double> dist(src_vertices.size() * columns, POSITIVE_INFINITY);
+    pool.parallel_for(0, static_cast<long long>(src_vertices.size()), 1, [&](int thread_id, long long i) {
+        double *row = dist.data() + i * columns;
+        upward_search(ch, src_vertices[i], true, workspaces[thread_id], [&](int vertex, double distance) {
+            for (int k = bucket_offsets[vertex]; k < bucket_offsets[vertex + 1]; ++k) {
+                row[buckets[k].column] = std::min(row[buckets[k].column], distance + buckets[k].dist);
+            }
+        });
+    });
+
+    return {src_vertices, dest_vertices, std::move(dist)};
+}
+
+void display_shortest_path(const ch_result &result) {
+    std::cout << "From " << result.src_vertex << " to " << result.dest_vertex << ": ["
+              << std::setw(4) << result.dist << "] ";
+    if (result.dist == POSITIVE_INFINITY) {
+        std::cout << "[unreachable]";
+    } else {
+        std::cout << "[" << result.path[0];
+        for (std::size_t i = 1; i < result.path.size(); ++i) {
+            std::cout << " -> " << result.path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+void display_distance_table(const distance_table_result &result) {
+    const std::size_t columns = result.dest_vertices.size();
+    std::cout << "        ";
+    for (const int dest_vertex: result.dest_vertices) {
+        std::cout << " " << std::setw(4) << dest_vertex;
+    }
+    std::cout << std::endl;
+    for (std::size_t i = 0; i < result.src_vertices.size(); ++i) {
+        std::cout << "From " << std::setw(2) << result.src_vertices[i] << ":";
+        for (std::size_t j = 0; j < columns; ++j) {
+            std::cout << " " << std::setw(4) << result.dist[i * columns + j];
+        }
+        std::cout << std::endl;
+    }
+}
+
+// A rows x columns grid where every vertex has edges to its 4 neighbors, with costs between 1 and 5.
+csr_graph make_grid_graph(int rows, int columns) {
+    std::vector<edge> edges;
+    const int moves[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            for (const auto &move: moves) {
+                const int nr = r + move[0], nc = c + move[1];
+                if (nr < 0 || nr >= rows || nc < 0 || nc >= columns) { continue; }
+                edges.push_back({r * columns + c, nr * columns + nc, static_cast<double>(1 + (r * 7 + c * 13) % 5)});
+            }
+        }
+    }
+    return {rows * columns, edges};
+}
+
+int main() {
+    std::cout << "Example 1" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const contraction_hierarchy ch(g);
+        ch_query engine(ch);
+        for (int dest_vertex = 0; dest_vertex < 12; ++dest_vertex) {
+            display_shortest_path(engine.query(1, dest_vertex));
+        }
+    }
+    std::cout << "Example 2" << std::endl;  // 100 x 100 grid, hierarchy saved and loaded back.
+    {
+        const csr_graph g = make_grid_graph(100, 100);
+        std::stringstream file;
+        contraction_hierarchy(g).save(file);
+        const contraction_hierarchy ch = contraction_hierarchy::load(file, g.size());
+        ch_query engine(ch);
+        const ch_result result = engine.query(2510, 7489);
+        std::cout << "Shortcuts: " << ch.shortcut_count() << std::endl;
+        std::cout << "From 2510 to 7489: [" << result.dist << "] (" << result.path.size() << " vertices, settled "
+                  << result.settled << ")" << std::endl;
+    }
+    std::cout << "Example 3" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const contraction_hierarchy ch(g);
+        thread_pool pool(4);
+        const distance_table_result result = distance_table(ch, {0, 1, 4, 5, 7}, {2, 6, 8, 10, 11}, pool);
+        display_distance_table(result);
+    }
+    return 0;
+}
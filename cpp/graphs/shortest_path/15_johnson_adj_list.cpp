@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../priority_queues.h"
+#include "../thread_pool.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+
+struct johnson_result {
+    // Vertices of a negative cycle (each one has an edge to the next, and the last one to the first), empty
+    // if the graph has none, in which case every row of the distance matrix has been reported.
+    const std::vector<int> negative_cycle;
+};
+
+// Queue-based Bellman-Ford with subtree disassembly (see 7_bellman_ford_adj_list.cpp) from a virtual source
+// with an edge of cost 0 to every vertex. On success h[v] holds the distance from the virtual source to v,
+// which is <= 0 and satisfies h[v] <= h[u] + cost(u, v) for every edge. The virtual source is the extra index
+// 'vertices' of the tree arrays, and its edges are never stored: every vertex simply starts with distance 0,
+// as a child of it, and in the queue. The search stops at the first negative cycle, which is returned.
+std::vector<int> bellman_ford_potentials(const csr_graph &graph, std::vector<double> &h) {
+    const int vertices = static_cast<int>(graph.size());
+    const int root = vertices;
+    h.assign(vertices, 0);
+    std::vector<int> parent(vertices, root);
+    // Shortest path tree in preorder as a doubly linked list. depth[i] == -1 means that vertex i is not in it.
+    std::vector<int> next(vertices + 1), prev(vertices + 1), depth(vertices + 1, 1);
+    for (int i = 0; i <= vertices; ++i) {
+        next[i] = i == root ? (vertices > 0 ? 0 : -1) : (i + 1 < vertices ? i + 1 : -1);
+        prev[i] = i == root ? -1 : (i > 0 ? i - 1 : root);
+    }
+    depth[root] = 0;
+    // in_queue[i] is false for vertices removed from the queue by a disassembly, which are skipped when popped.
+    std::vector<bool> in_queue(vertices, true);
+    std::queue<int> q;
+    for (int i = 0; i < vertices; ++i) { q.push(i); }
+
+    while (!q.empty()) {
+        const int vertex = q.front(); q.pop();
+        if (!in_queue[vertex]) { continue; }
+        in_queue[vertex] = false;
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (h[vertex] + edge.cost >= h[edge.to]) { continue; }
+            // Remove the subtree of 'edge.to' (but 'edge.to' itself) from the tree and from the queue.
+            bool negative_cycle = edge.to == vertex;
+            int after = depth[edge.to] == -1 ? -1 : next[edge.to];
+            for (; after != -1 && depth[after] > depth[edge.to]; after = next[after]) {
+                negative_cycle = negative_cycle || after == vertex;
+                depth[after] = -1;
+                in_queue[after] = false;
+            }
+            if (negative_cycle) {
+                // The tree path 'edge.to' ~> 'vertex' plus this edge.
+                std::vector<int> cycle;
+                for (int at = vertex; at != edge.to; at = parent[at]) { cycle.push_back(at); }
+                cycle.push_back(edge.to);
+                std::reverse(cycle.begin(), cycle.end());
+                return cycle;
+            }
+            if (depth[edge.to] != -1) {
+                // Unlink 'edge.to' and its subtree, which are the vertices between it and 'after'.
+                next[prev[edge.to]] = after;
+                if (after != -1) { prev[after] = prev[edge.to]; }
+            }
+            h[edge.to] = h[vertex] + edge.cost;
+            parent[edge.to] = vertex;
+            // Link 'edge.to' as the first child of 'vertex'.
+            depth[edge.to] = depth[vertex] + 1;
+            prev[edge.to] = vertex;
+            next[edge.to] = next[vertex];
+            if (next[vertex] != -1) { prev[next[vertex]] = edge.to; }
+            next[vertex] = edge.to;
+            if (!in_queue[edge.to]) {
+                in_queue[edge.to] = true;
+                q.push(edge.to);
+            }
+        }
+    }
+    return {};
+}
+
+// Johnson's algorithm (1977) for All Pairs Shortest Path (APSP) on sparse graphs with negative weights. One
+// Bellman-Ford run computes vertex potentials h, and every edge is reweighted to cost(u, v) + h[u] - h[v],
+// which is never negative and shifts the cost of every path from s to t by the same h[s] - h[t], so shortest
+// paths are preserved. Then a Dijkstra from every vertex (V independent runs, spread over the threads of
+// 'pool') gives the distances in the reweighted graph, which are shifted back. This takes O(VE + V(V+E)log(V))
+// instead of the O(V^3) of Floyd-Warshall.
+// The distance matrix is never stored: 'row(src_vertex, dist, parent)' is called once per source as soon as
+// its Dijkstra finishes, where dist[v] is the distance from 'src_vertex' to v (POSITIVE_INFINITY if it is
+// unreachable) and parent[v] the vertex before v in the shortest path (-1 for 'src_vertex' and unreachable
+// vertices). Both vectors are only valid during the call. The rows arrive in no particular order and 'row' is
+// called concurrently from several threads, so it must only write to per-source data or synchronize itself.
+// If the graph has a negative cycle no row is reported and the cycle is returned.
+template<typename RowSink>
+johnson_result johnson(const csr_graph &graph, thread_pool &pool, const RowSink &row) {
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<double> h;
+    std::vector<int> negative_cycle = bellman_ford_potentials(graph, h);
+    if (!negative_cycle.empty()) { return {std::move(negative_cycle)}; }
+
+    std::vector<edge> edges;
+    edges.reserve(graph.edge_count());
+    for (int v = 0; v < vertices; ++v) {
+        for (const auto e: graph.adj_list(v)) {
+            // The reweighted cost is >= 0 in exact arithmetic, rounding errors could make it slightly negative.
+            edges.push_back({v, e.to, std::max(e.cost + h[v] - h[e.to], 0.0)});
+        }
+    }
+    const csr_graph reweighted(vertices, edges);
+    edges = std::vector<edge>();
+
+    // Per-thread Dijkstra state, reused for all the sources handled by that thread.
+    struct workspace {
+        std::vector<double> dist;
+        std::vector<int> parent;
+        indexed_dary_heap<4> pq;
+        explicit workspace(int vertices) : dist(vertices), parent(vertices), pq(vertices) {}
+    };
+    std::vector<workspace> workspaces(pool.size(), workspace(vertices));
+    pool.parallel_for(0, vertices, 1, [&](int thread_id, long long i) {
+        const int src_vertex = static_cast<int>(i);
+        workspace &ws = workspaces[thread_id];
+        std::fill(ws.dist.begin(), ws.dist.end(), POSITIVE_INFINITY);
+        std::fill(ws.parent.begin(), ws.parent.end(), -1);
+        ws.dist[src_vertex] = 0;
+        ws.pq.push(src_vertex, 0);
+        while (!ws.pq.empty()) {
+            const int vertex = ws.pq.top();
+            ws.pq.pop();
+            for (const auto edge: reweighted.adj_list(vertex)) {
+                if (ws.dist[vertex] + edge.cost < ws.dist[edge.to]) {
+                    ws.dist[edge.to] = ws.dist[vertex] + edge.cost;
+                    ws.parent[edge.to] = vertex;
+                    ws.pq.push(edge.to, ws.dist[edge.to]);
+                }
+            }
+        }
+        for (int v = 0; v < vertices; ++v) {
+            if (ws.dist[v] != POSITIVE_INFINITY) { ws.dist[v] += h[v] - h[src_vertex]; }
+        }
+        row(src_vertex, ws.dist, ws.parent);
+    });
+    return {{}};
+}
+
+void display_distance_matrix(const std::vector<std::vector<double>> &dist) {
+    const int vertices = static_cast<int>(dist.size());
+    std::cout << "        ";
+    for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
+        std::cout << " " << std::setw(4) << dest_vertex;
+    }
+    std::cout << std::endl;
+    for (int src_vertex = 0; src_vertex < vertices; ++src_vertex) {
+        std::cout << "From " << std::setw(2) << src_vertex << ":";
+        for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
+            std::cout << " " << std::setw(4) << dist[src_vertex][dest_vertex];
+        }
+        std::cout << std::endl;
+    }
+}
+
+void display_negative_cycle(const johnson_result &result) {
+    if (result.negative_cycle.empty()) {
+        std::cout << "[no negative cycle]" << std::endl;
+        return;
+    }
+    std::cout << "Negative cycle: [" << result.negative_cycle[0];
+    for (std::size_t i = 1; i < result.negative_cycle.size(); ++i) {
+        std::cout << " -> " << result.negative_cycle[i];
+    }
+    std::cout << " -> " << result.negative_cycle[0] << "]" << std::endl;
+}
+
+int main() {
+    std::cout << "Example 1" << std::endl;  // Introduction to Algorithms (CLRS), 3rd ed., Figure 25.6
+    {
+        const csr_graph g(5, {
+                {0, 1, 3},
+                {0, 2, 8},
+                {0, 4, -4},
+                {1, 3, 1},
+                {1, 4, 7},
+                {2, 1, 4},
+                {3, 0, 2},
+                {3, 2, -5},
+                {4, 3, 6},
+        });
+        thread_pool pool(4);
+        // Each source writes its own row, so no synchronization is needed to collect the whole matrix.
+        std::vector<std::vector<double>> dist(g.size());
+        const johnson_result result = johnson(g, pool, [&](int src_vertex, const std::vector<double> &row,
+                                                           const std::vector<int> &) {
+            dist[src_vertex] = row;
+        });
+        display_negative_cycle(result);
+        display_distance_matrix(dist);
+    }
+    std::cout << "Example 2" << std::endl;  // https://www.youtube.com/watch?v=lyw4FaxrwHg (graph example 2)
+    {
+        const csr_graph g(10, {
+                {0, 1, 5},
+                {1, 2, 20},
+                {1, 5, 30},
+                {1, 6, 60},
+                {2, 3, 10},
+                {2, 4, 75},
+                {3, 2, -15},
+                {4, 9, 100},
+                {5, 4, 25},
+                {5, 6, 5},
+                {5, 8, 50},
+                {6, 7, -50},
+                {7, 8, -10},
+        });
+        thread_pool pool(4);
+        const johnson_result result = johnson(g, pool, [](int, const std::vector<double> &,
+                                                          const std::vector<int> &) {});
+        display_negative_cycle(result);
+    }
+    std::cout << "Example 3" << std::endl;  // Introduction to Algorithms (CLRS), 3rd ed., Figure 25.6
+    {
+        const csr_graph g(5, {
+                {0, 1, 3},
+                {0, 2, 8},
+                {0, 4, -4},
+                {1, 3, 1},
+                {1, 4, 7},
+                {2, 1, 4},
+                {3, 0, 2},
+                {3, 2, -5},
+                {4, 3, 6},
+        });
+        thread_pool pool(4);
+        // Longest shortest path from every vertex, reducing each row as it arrives instead of keeping it.
+        std::vector<double> eccentricity(g.size(), 0);
+        std::vector<std::vector<int>> longest_path(g.size());
+        johnson(g, pool, [&](int src_vertex, const std::vector<double> &row, const std::vector<int> &parent) {
+            int farthest = src_vertex;
+            for (int v = 0; v < static_cast<int>(row.size()); ++v) {
+                if (row[v] != POSITIVE_INFINITY && row[v] > row[farthest]) { farthest = v; }
+            }
+            eccentricity[src_vertex] = row[farthest];
+            for (int at = farthest; at != -1; at = parent[at]) { longest_path[src_vertex].push_back(at); }
+            std::reverse(longest_path[src_vertex].begin(), longest_path[src_vertex].end());
+        });
+        for (std::size_t src_vertex = 0; src_vertex < g.size(); ++src_vertex) {
+            const std::vector<int> &path = longest_path[src_vertex];
+            std::cout << "From " << src_vertex << " to " << path.back() << ": ["
+                      << std::setw(4) << eccentricity[src_vertex] << "] [" << path[0];
+            for (std::size_t i = 1; i < path.size(); ++i) {
+                std::cout << " -> " << path[i];
+            }
+            std::cout << "]" << std::endl;
+        }
+    }
+    return 0;
+}
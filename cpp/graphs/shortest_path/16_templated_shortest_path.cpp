@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../shortest_path.h"
+
+template<typename Result>
+void display_shortest_path(const Result &result, typename Result::vertex_type dest_vertex) {
+    typedef typename Result::vertex_type vertex_type;
+    typedef typename Result::traits traits;
+    std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": [" << std::setw(4);
+    if (result.dist[dest_vertex] == traits::infinity()) {
+        std::cout << "inf" << "] [unreachable]";
+    } else if (result.dist[dest_vertex] == traits::negative_infinity()) {
+        std::cout << "-inf" << "] [negative cycle]";
+    } else {
+        std::cout << result.dist[dest_vertex] << "] ";
+        std::vector<vertex_type> path;
+        for (vertex_type at = dest_vertex; at != no_vertex<vertex_type>(); at = result.parent[at]) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+        std::cout << "[" << path[0];
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            std::cout << " -> " << path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+template<typename Result>
+void display_all_shortest_paths(const Result &result) {
+    for (typename Result::vertex_type dest_vertex = 0; dest_vertex < result.dist.size(); ++dest_vertex) {
+        display_shortest_path(result, dest_vertex);
+    }
+}
+
+int main() {
+    std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
+    {
+        // The same weighted graph in the three representations that can list the outgoing edges of a vertex.
+        const std::vector<basic_edge<double, std::uint32_t>> edges = {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        };
+        const auto from_list = dijkstra(basic_adj_list<double, std::uint32_t>(6, edges), 0);
+        const auto from_matrix = dijkstra(basic_adj_matrix<double, std::uint32_t>(6, edges), 0);
+        const auto from_csr = dijkstra(basic_csr_graph<double, std::uint32_t>(6, edges), 0);
+        display_all_shortest_paths(from_csr);
+        std::cout << "Same distances with the adjacency list and matrix: "
+                  << (from_list.dist == from_csr.dist && from_matrix.dist == from_csr.dist ? "yes" : "no")
+                  << std::endl;
+    }
+    std::cout << "Example 2" << std::endl;  // https://www.youtube.com/watch?v=lyw4FaxrwHg (graph example 2)
+    {
+        // Integer weights and 64-bit indices on an edge list.
+        const basic_edge_list<std::int64_t, std::uint64_t> g(10, {
+                {0, 1, 5},
+                {1, 2, 20},
+                {1, 5, 30},
+                {1, 6, 60},
+                {2, 3, 10},
+                {2, 4, 75},
+                {3, 2, -15},
+                {4, 9, 100},
+                {5, 4, 25},
+                {5, 6, 5},
+                {5, 8, 50},
+                {6, 7, -50},
+                {7, 8, -10},
+        });
+        display_all_shortest_paths(bellman_ford(g, 0));
+    }
+    std::cout << "Example 3" << std::endl;  // resources/digraph_unweighted.svg
+    {
+        // Unweighted graph: the edges are just pairs of indices, and the matrix is a bitset.
+        const std::vector<basic_edge<void, std::uint32_t>> edges = {
+                {0, 1},
+                {1, 2},
+                {1, 3},
+                {1, 4},
+                {2, 5},
+                {3, 5},
+                {4, 3},
+                {4, 4},
+                {4, 6},
+                {5, 2},
+                {5, 6},
+                {5, 7},
+                {6, 9},
+                {7, 8},
+                {7, 10},
+                {8, 6},
+                {9, 8},
+        };
+        const auto from_matrix = bfs(basic_adj_matrix<void, std::uint32_t>(12, edges), 0);
+        const auto from_csr = bfs(basic_csr_graph<void, std::uint32_t>(12, edges), 0);
+        display_all_shortest_paths(from_csr);
+        std::cout << "Same distances with the bitset matrix: " << (from_matrix.dist == from_csr.dist ? "yes" : "no")
+                  << std::endl;
+    }
+    std::cout << "Example 4" << std::endl;
+    {
+        // Memory taken by a random graph with 100000 vertices and 1000000 edges.
+        const int vertices = 100000, edge_count = 1000000;
+        std::mt19937 rng(1);
+        std::vector<edge> edges;
+        std::vector<basic_edge<void, std::uint32_t>> unweighted_edges;
+        for (int i = 0; i < edge_count; ++i) {
+            const int from = static_cast<int>(rng() % vertices), to = static_cast<int>(rng() % vertices);
+            edges.push_back({from, to, 1});
+            unweighted_edges.push_back({static_cast<std::uint32_t>(from), static_cast<std::uint32_t>(to)});
+        }
+        const csr_graph g(vertices, edges);
+        const basic_csr_graph<void, std::uint32_t> unweighted(vertices, unweighted_edges);
+        // 'csr_graph' stores int offsets and targets, and a double cost per edge.
+        const std::size_t csr_graph_bytes = (g.size() + 1 + g.edge_count()) * sizeof(int)
+                                            + g.edge_count() * sizeof(double);
+        std::cout << "csr_graph:                         " << std::setw(9) << csr_graph_bytes << " bytes" << std::endl;
+        std::cout << "basic_csr_graph<void, uint32_t>:   " << std::setw(9) << unweighted.memory_bytes() << " bytes"
+                  << std::endl;
+    }
+    return 0;
+}
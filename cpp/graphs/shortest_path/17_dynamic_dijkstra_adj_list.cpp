@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "../csr_graph.h"
+#include "../priority_queues.h"
+
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
+
+struct dijkstra_result {
+    const int src_vertex;
+    const std::vector<double> dist;
+    const std::vector<int> parent;
+};
+
+// New cost of the edge at position 'edge' of the edge list the graph was built from.
+struct edge_update {
+    const int edge;
+    const double cost;
+};
+
+// Single source shortest paths kept up to date while the edge costs change, in the style of Ramalingam &
+// Reps (1996). The edges are identified by their position in the edge list, and a batch of updates is
+// repaired in a single pass that only touches the vertices whose distance may change:
+// 1. An increased edge only matters if it is the parent edge of its target v in the shortest path tree. Then
+//    every vertex of the subtree of v loses its path and is 'affected': its distance is reset, and the best
+//    edge coming from an unaffected vertex gives it a first estimate.
+// 2. A decreased edge u -> v is relaxed, and v is queued if it improves.
+// 3. A Dijkstra seeded with all the queued vertices propagates the changes. Unaffected vertices keep valid
+//    upper bounds, so they are only scanned again if their distance improves.
+// The costs must stay non-negative. The graph is stored as two CSR arrays of edge ids (outgoing and incoming
+// edges of every vertex) over a mutable cost array, since 'csr_graph' has immutable costs and no incoming
+// edges.
+class dynamic_dijkstra {
+private:
+    int src_vertex;
+    std::vector<int> from, to;
+    std::vector<double> cost;
+    std::vector<int> out_offsets, out_edges, in_offsets, in_edges;
+    std::vector<double> dist;
+    std::vector<int> parent_edge;
+    indexed_dary_heap<4> pq;
+    // Scratch space of 'update', all false between batches.
+    std::vector<bool> affected;
+
+    static void build_csr(int vertices, const std::vector<int> &key, std::vector<int> &offsets,
+                          std::vector<int> &ids) {
+        offsets.assign(vertices + 1, 0);
+        for (const int k: key) { ++offsets[k + 1]; }
+        for (int v = 0; v < vertices; ++v) { offsets[v + 1] += offsets[v]; }
+        ids.resize(key.size());
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (int e = 0; e < static_cast<int>(key.size()); ++e) { ids[next[key[e]]++] = e; }
+    }
+    void relax(int e) {
+        if (dist[from[e]] + cost[e] < dist[to[e]]) {
+            dist[to[e]] = dist[from[e]] + cost[e];
+            parent_edge[to[e]] = e;
+            pq.push(to[e], dist[to[e]]);
+        }
+    }
+    // Dijkstra from the vertices in the queue. Returns the number of vertices taken out of it.
+    int propagate() {
+        int settled = 0;
+        while (!pq.empty()) {
+            const int vertex = pq.top();
+            pq.pop();
+            ++settled;
+            for (int i = out_offsets[vertex]; i < out_offsets[vertex + 1]; ++i) { relax(out_edges[i]); }
+        }
+        return settled;
+    }
+public:
+    dynamic_dijkstra(int vertices, const std::vector<edge> &edges, int src_vertex)
+            : src_vertex(src_vertex), dist(vertices, POSITIVE_INFINITY), parent_edge(vertices, -1),
+              pq(vertices), affected(vertices, false) {
+        for (const auto &e: edges) {
+            assert(0 <= e.from && e.from < vertices && 0 <= e.to && e.to < vertices && e.cost >= 0);
+            from.push_back(e.from);
+            to.push_back(e.to);
+            cost.push_back(e.cost);
+        }
+        build_csr(vertices, from, out_offsets, out_edges);
+        build_csr(vertices, to, in_offsets, in_edges);
+        dist[src_vertex] = 0;
+        pq.push(src_vertex, 0);
+        propagate();
+    }
+    // Applies a batch of cost changes and repairs the shortest paths. Returns the number of vertices scanned
+    // by the repair, against the V of a Dijkstra from scratch.
+    int update(const std::vector<edge_update> &updates) {
+        std::vector<int> affected_vertices, decreased;
+        for (const auto &u: updates) {
+            assert(0 <= u.edge && u.edge < static_cast<int>(cost.size()) && u.cost >= 0);
+            const int v = to[u.edge];
+            if (u.cost > cost[u.edge] && parent_edge[v] == u.edge && !affected[v]) {
+                // The subtree of v, through the edges that are the parent edge of their target.
+                affected[v] = true;
+                const std::size_t first = affected_vertices.size();
+                affected_vertices.push_back(v);
+                for (std::size_t i = first; i < affected_vertices.size(); ++i) {
+                    const int vertex = affected_vertices[i];
+                    for (int j = out_offsets[vertex]; j < out_offsets[vertex + 1]; ++j) {
+                        const int e = out_edges[j];
+                        if (parent_edge[to[e]] == e && !affected[to[e]]) {
+                            affected[to[e]] = true;
+                            affected_vertices.push_back(to[e]);
+                        }
+                    }
+                }
+            } else if (u.cost < cost[u.edge]) {
+                decreased.push_back(u.edge);
+            }
+            cost[u.edge] = u.cost;
+        }
+
+        for (const int v: affected_vertices) {
+            dist[v] = POSITIVE_INFINITY;
+            parent_edge[v] = -1;
+        }
+        for (const int v: affected_vertices) {
+            for (int i = in_offsets[v]; i < in_offsets[v + 1]; ++i) {
+                if (!affected[from[in_edges[i]]]) { relax(in_edges[i]); }
+            }
+        }
+        for (const int e: decreased) { relax(e); }
+        for (const int v: affected_vertices) { affected[v] = false; }
+        return propagate();
+    }
+    dijkstra_result result() const {
+        std::vector<int> parent(dist.size(), -1);
+        for (std::size_t v = 0; v < dist.size(); ++v) {
+            if (parent_edge[v] != -1) { parent[v] = from[parent_edge[v]]; }
+        }
+        return {src_vertex, dist, std::move(parent)};
+    }
+};
+
+void display_shortest_path(const dijkstra_result &result, int dest_vertex) {
+    std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
+              << std::setw(4) << result.dist[dest_vertex] << "] ";
+    if (result.dist[dest_vertex] == POSITIVE_INFINITY) {
+        std::cout << "[unreachable]";
+    } else {
+        std::vector<int> path;
+        for (int at = dest_vertex; at != -1; at = result.parent[at]) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+        std::cout << "[" << path[0];
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            std::cout << " -> " << path[i] << "";
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+void display_all_shortest_paths(const dijkstra_result &result) {
+    const int vertices = static_cast<int>(result.dist.size());
+    for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
+        display_shortest_path(result, dest_vertex);
+    }
+}
+
+int main() {
+    std::cout << "Example 1" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        dynamic_dijkstra d(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        }, 1);
+        display_all_shortest_paths(d.result());
+        // The edge 4 -> 3 gets much more expensive, and 4 -> 6 and 1 -> 2 cheaper, in a single batch.
+        std::cout << "Updating 4 -> 3 to 10, 4 -> 6 to 2 and 1 -> 2 to 3" << std::endl;
+        const int settled = d.update({{6, 10}, {8, 2}, {1, 3}});
+        display_all_shortest_paths(d.result());
+        std::cout << "Vertices scanned by the repair: " << settled << std::endl;
+    }
+    return 0;
+}
@@ -1,39 +1,54 @@
 #include <algorithm>
 #include <cassert>
+#include <atomic>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <queue>
+#include <utility>
 #include <vector>
 
+#include "../csr_graph.h"
+#include "../stamped_array.h"
+#include "../thread_pool.h"
+
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 
-// Directed edge with a cost.
-struct edge {
-    const int from, to;
-    const double cost;
+struct bfs_result {
+    const int src_vertex;
+    const std::vector<double> dist;
+    const std::vector<int> parent;
 };
 
-// Directed graph with adjacency lists.
-class graph {
-private:
-    std::vector<std::vector<edge>> adj_lists;
-public:
-    explicit graph(int vertices) : adj_lists(vertices, std::vector<edge>()) {}
-    std::size_t size() const { return adj_lists.size(); }
-    const std::vector<edge> &adj_list(int vertex) const { return adj_lists[vertex]; }
-    void add_edge(int vertex, const edge &e) {
-        assert(vertex == e.from);
-        adj_lists[vertex].push_back(e);
-    }
+// Memory kept by the caller across many queries of 'bfs' on the same graph, so that a query does not allocate
+// nor initialize anything of size V. The labels are reset through their generation stamps, and 'queue' keeps
+// its capacity from one query to the next.
+struct bfs_workspace {
+    stamped_array<double> dist;
+    stamped_array<int> parent;
+    std::vector<int> queue;
+    explicit bfs_workspace(int vertices) : dist(vertices, POSITIVE_INFINITY), parent(vertices, -1) {}
 };
 
-struct bfs_result {
+// Result of a query run on a workspace. It refers to the arrays of the workspace instead of copying them, so
+// it is only valid until the next query on the same workspace.
+struct bfs_view {
     const int src_vertex;
+    const stamped_array<double> &dist;
+    const stamped_array<int> &parent;
+};
+
+// Maximum number of sources answered by a single multi-source BFS traversal, one per bit of a word.
+constexpr int MS_BFS_BATCH_SIZE = 64;
+
+struct ms_bfs_result {
+    const std::vector<int> src_vertices;
+    // Row-major |src_vertices| x V matrix, dist[i * V + j] is the distance from 'src_vertices[i]' to vertex j.
     const std::vector<double> dist;
-    const std::vector<int> parent;
 };
 
-bfs_result bfs(const graph &graph, int src_vertex) {
+bfs_result bfs(const csr_graph &graph, int src_vertex) {
     const int vertices = static_cast<int>(graph.size());
     // Initialize the distance to all vertices to be infinity except for the start vertex which is zero.
     // dist[i] is the current shortest distance from 'src_vertex' to vertex i.
@@ -48,12 +63,12 @@ bfs_result bfs(const graph &graph, int src_vertex) {
 
     while (!q.empty()) {
         const int vertex = q.front(); q.pop();
-        for (const auto &edge: graph.adj_list(vertex)) {
+        for (const auto edge: graph.adj_list(vertex)) {
             // We enqueue only the unvisited neighboring vertices.
             if (dist[edge.to] == POSITIVE_INFINITY) {
-                dist[edge.to] = dist[edge.from] + 1;
+                dist[edge.to] = dist[vertex] + 1;
                 q.push(edge.to);
-                parent[edge.to] = edge.from;
+                parent[edge.to] = vertex;
             }
         }
         // If we are trying to solve 'Single Pair Shortest Path (SPSP)' we can add a new function parameter
@@ -64,10 +79,198 @@ bfs_result bfs(const graph &graph, int src_vertex) {
         // returning a 'bfs_result', which means that 'dest_vertex' is not reachable from 'src_vertex'.
     }
 
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Same search on the memory of 'workspace', for high query rates on a large graph. Resetting the labels is
+// O(1) and every query only costs the vertices it reaches. The queue is a plain vector read from 'head',
+// since every vertex is enqueued at most once.
+bfs_view bfs(const csr_graph &graph, int src_vertex, bfs_workspace &workspace) {
+    assert(workspace.dist.size() == graph.size());
+    stamped_array<double> &dist = workspace.dist;
+    stamped_array<int> &parent = workspace.parent;
+    std::vector<int> &queue = workspace.queue;
+    dist.reset();
+    parent.reset();
+    queue.clear();
+    dist.set(src_vertex, 0);
+    queue.push_back(src_vertex);
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const int vertex = queue[head];
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (!dist.touched(edge.to)) {
+                dist.set(edge.to, dist[vertex] + 1);
+                queue.push_back(edge.to);
+                parent.set(edge.to, vertex);
+            }
+        }
+    }
+
     return {src_vertex, dist, parent};
 }
 
-void display_shortest_path(const bfs_result &result, int dest_vertex) {
+// Direction-optimizing BFS (Beamer, Asanovic & Patterson, 2012). The classic 'top-down' step above checks
+// every edge leaving the frontier, even though on low-diameter graphs most of them lead to vertices that
+// were already visited. When the frontier grows large it is cheaper to go 'bottom-up': every unvisited
+// vertex scans its incoming edges and stops at the first parent that is in the frontier, which is kept
+// as a bitmap for O(1) membership tests. 'reverse_graph' must be 'graph.reversed()'. The heuristic switches
+// to bottom-up when the edges to check from the frontier exceed 1/alpha of the edges left to explore, and
+// back to top-down when the frontier shrinks below 1/beta of the vertices. Distances are the same as the
+// ones computed by 'bfs', parents may differ among the equally short alternatives.
+bfs_result bfs_direction_optimizing(const csr_graph &graph, const csr_graph &reverse_graph, int src_vertex,
+                                    int alpha = 15, int beta = 18) {
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+    // The frontier is kept as a list of vertices for top-down steps and also as a bitmap (one bit per
+    // vertex) for bottom-up steps.
+    std::vector<int> frontier = {src_vertex}, next;
+    std::vector<std::uint64_t> frontier_bitmap((vertices + 63) / 64, 0);
+    // Edges leaving the vertices that have not been visited yet.
+    long long unexplored_edges = static_cast<long long>(graph.edge_count()) - graph.degree(src_vertex);
+    bool bottom_up = false;
+
+    for (int level = 1; !frontier.empty(); ++level) {
+        long long frontier_edges = 0;
+        for (const int vertex: frontier) { frontier_edges += graph.degree(vertex); }
+        if (!bottom_up && frontier_edges > unexplored_edges / alpha) {
+            bottom_up = true;
+        } else if (bottom_up && static_cast<long long>(frontier.size()) * beta < vertices) {
+            bottom_up = false;
+        }
+        next.clear();
+        if (bottom_up) {
+            std::fill(frontier_bitmap.begin(), frontier_bitmap.end(), 0);
+            for (const int vertex: frontier) { frontier_bitmap[vertex >> 6] |= std::uint64_t{1} << (vertex & 63); }
+            for (int vertex = 0; vertex < vertices; ++vertex) {
+                if (dist[vertex] != POSITIVE_INFINITY) { continue; }
+                for (const auto edge: reverse_graph.adj_list(vertex)) {
+                    // Here 'edge.to' is the vertex the incoming edge comes from.
+                    if (frontier_bitmap[edge.to >> 6] >> (edge.to & 63) & 1) {
+                        dist[vertex] = level;
+                        parent[vertex] = edge.to;
+                        next.push_back(vertex);
+                        break;
+                    }
+                }
+            }
+        } else {
+            for (const int vertex: frontier) {
+                for (const auto edge: graph.adj_list(vertex)) {
+                    if (dist[edge.to] == POSITIVE_INFINITY) {
+                        dist[edge.to] = level;
+                        parent[edge.to] = vertex;
+                        next.push_back(edge.to);
+                    }
+                }
+            }
+        }
+        for (const int vertex: next) { unexplored_edges -= graph.degree(vertex); }
+        frontier.swap(next);
+    }
+
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Level-synchronous parallel BFS. The vertices of the current frontier are split among the threads of
+// 'pool' (the thread count is chosen when creating the pool), and each thread collects the vertices it
+// discovers in its own local frontier, so no locking is needed on the hot path. Two threads can reach the
+// same unvisited vertex in the same level; an atomic compare-and-swap on 'parent' decides which one claims
+// it. Since a vertex is always claimed at the level it is first reached, 'dist' is the same for any number
+// of threads, while 'parent' may be any of the equally short alternatives.
+bfs_result bfs_parallel(const csr_graph &graph, int src_vertex, thread_pool &pool) {
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    // parent[i] == -1 means that vertex i has not been claimed yet, so 'src_vertex' is its own parent while
+    // the search runs.
+    std::vector<std::atomic<int>> parent(vertices);
+    for (auto &p: parent) { p.store(-1, std::memory_order_relaxed); }
+    parent[src_vertex].store(src_vertex, std::memory_order_relaxed);
+    std::vector<int> frontier = {src_vertex};
+    std::vector<std::vector<int>> local_frontiers(pool.size());
+
+    for (int level = 1; !frontier.empty(); ++level) {
+        pool.parallel_for(0, static_cast<long long>(frontier.size()), 64, [&](int thread_id, long long i) {
+            const int vertex = frontier[i];
+            for (const auto edge: graph.adj_list(vertex)) {
+                // Cheap check first, so the compare-and-swap is only tried on vertices still unclaimed.
+                if (parent[edge.to].load(std::memory_order_relaxed) != -1) { continue; }
+                int unclaimed = -1;
+                if (parent[edge.to].compare_exchange_strong(unclaimed, vertex, std::memory_order_relaxed)) {
+                    dist[edge.to] = level;
+                    local_frontiers[thread_id].push_back(edge.to);
+                }
+            }
+        });
+        frontier.clear();
+        for (auto &local_frontier: local_frontiers) {
+            frontier.insert(frontier.end(), local_frontier.begin(), local_frontier.end());
+            local_frontier.clear();
+        }
+    }
+
+    std::vector<int> result_parent(vertices);
+    for (int i = 0; i < vertices; ++i) { result_parent[i] = parent[i].load(std::memory_order_relaxed); }
+    result_parent[src_vertex] = -1;
+    return {src_vertex, std::move(dist), std::move(result_parent)};
+}
+
+// Multi-Source BFS (Then et al., 2014) computes the BFS distances from up to 'MS_BFS_BATCH_SIZE' sources with
+// a single traversal. Source i owns bit i of a 64-bit word, and every vertex keeps the set of sources that
+// have already seen it ('seen') and the set of sources whose frontier contains it ('visit'). Expanding a
+// vertex forwards all its frontier bits to every neighbor at once with a few bitwise operations, so the
+// adjacency lists are read once per level for the whole batch instead of once per source, which is what
+// makes computing distances from thousands of sources (closeness, eccentricity) affordable. Longer lists of
+// sources are split into batches of 'MS_BFS_BATCH_SIZE', one traversal each.
+ms_bfs_result ms_bfs(const csr_graph &graph, const std::vector<int> &src_vertices) {
+    const int vertices = static_cast<int>(graph.size());
+    const int sources = static_cast<int>(src_vertices.size());
+    std::vector<double> dist(static_cast<std::size_t>(sources) * vertices, POSITIVE_INFINITY);
+    std::vector<std::uint64_t> seen(vertices), visit(vertices), visit_next(vertices);
+    for (int first = 0; first < sources; first += MS_BFS_BATCH_SIZE) {
+        // Bit i stands for source 'first + i', whose distances are row 'first + i' of 'dist'.
+        const int batch = std::min(MS_BFS_BATCH_SIZE, sources - first);
+        double *batch_dist = dist.data() + static_cast<std::size_t>(first) * vertices;
+        std::fill(seen.begin(), seen.end(), 0);
+        std::fill(visit.begin(), visit.end(), 0);
+        for (int i = 0; i < batch; ++i) {
+            seen[src_vertices[first + i]] |= std::uint64_t{1} << i;
+            visit[src_vertices[first + i]] |= std::uint64_t{1} << i;
+            batch_dist[static_cast<std::size_t>(i) * vertices + src_vertices[first + i]] = 0;
+        }
+
+        bool active = true;
+        for (int level = 1; active; ++level) {
+            active = false;
+            for (int vertex = 0; vertex < vertices; ++vertex) {
+                if (visit[vertex] == 0) { continue; }
+                for (const auto edge: graph.adj_list(vertex)) {
+                    // Sources reaching 'edge.to' for the first time through 'vertex'.
+                    std::uint64_t discovered = visit[vertex] & ~seen[edge.to];
+                    if (discovered == 0) { continue; }
+                    seen[edge.to] |= discovered;
+                    visit_next[edge.to] |= discovered;
+                    active = true;
+                    for (; discovered != 0; discovered &= discovered - 1) {
+                        const int i = __builtin_ctzll(discovered);
+                        batch_dist[static_cast<std::size_t>(i) * vertices + edge.to] = level;
+                    }
+                }
+            }
+            visit.swap(visit_next);
+            std::fill(visit_next.begin(), visit_next.end(), 0);
+        }
+    }
+
+    return {src_vertices, std::move(dist)};
+}
+
+// 'Result' is either a 'bfs_result' or a 'bfs_view'.
+template<typename Result>
+void display_shortest_path(const Result &result, int dest_vertex) {
     std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
               << std::setw(4) << result.dist[dest_vertex] << "] ";
     if (result.dist[dest_vertex] == POSITIVE_INFINITY) {
@@ -87,36 +290,161 @@ void display_shortest_path(const bfs_result &result, int dest_vertex) {
     std::cout << std::endl;
 }
 
-void display_all_shortest_paths(const bfs_result &result) {
+template<typename Result>
+void display_all_shortest_paths(const Result &result) {
     const int vertices = static_cast<int>(result.dist.size());
     for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
         display_shortest_path(result, dest_vertex);
     }
 }
 
+void display_distance_matrix(const ms_bfs_result &result) {
+    const int sources = static_cast<int>(result.src_vertices.size());
+    const int vertices = sources == 0 ? 0 : static_cast<int>(result.dist.size()) / sources;
+    for (int i = 0; i < sources; ++i) {
+        std::cout << "From " << std::setw(2) << result.src_vertices[i] << ":";
+        for (int j = 0; j < vertices; ++j) {
+            std::cout << " " << std::setw(3) << result.dist[static_cast<std::size_t>(i) * vertices + j];
+        }
+        std::cout << std::endl;
+    }
+}
+
 int main() {
     std::cout << "Example 1" << std::endl;  // resources/digraph_unweighted.svg
     {
-        graph g(12);
-        g.add_edge(0, {0, 1, 1});
-        g.add_edge(1, {1, 2, 1});
-        g.add_edge(1, {1, 3, 1});
-        g.add_edge(1, {1, 4, 1});
-        g.add_edge(2, {2, 5, 1});
-        g.add_edge(3, {3, 5, 1});
-        g.add_edge(4, {4, 3, 1});
-        g.add_edge(4, {4, 4, 1});
-        g.add_edge(4, {4, 6, 1});
-        g.add_edge(5, {5, 2, 1});
-        g.add_edge(5, {5, 6, 1});
-        g.add_edge(5, {5, 7, 1});
-        g.add_edge(6, {6, 9, 1});
-        g.add_edge(7, {7, 8, 1});
-        g.add_edge(7, {7, 10, 1});
-        g.add_edge(8, {8, 6, 1});
-        g.add_edge(9, {9, 8, 1});
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {1, 3, 1},
+                {1, 4, 1},
+                {2, 5, 1},
+                {3, 5, 1},
+                {4, 3, 1},
+                {4, 4, 1},
+                {4, 6, 1},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 1},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 1},
+                {9, 8, 1},
+        });
         const bfs_result result = bfs(g, 1);
         display_all_shortest_paths(result);
     }
+    std::cout << "Example 2" << std::endl;  // resources/digraph_unweighted.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {1, 3, 1},
+                {1, 4, 1},
+                {2, 5, 1},
+                {3, 5, 1},
+                {4, 3, 1},
+                {4, 4, 1},
+                {4, 6, 1},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 1},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 1},
+                {9, 8, 1},
+        });
+        const bfs_result result = bfs_direction_optimizing(g, g.reversed(), 1);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 3" << std::endl;  // resources/digraph_unweighted.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {1, 3, 1},
+                {1, 4, 1},
+                {2, 5, 1},
+                {3, 5, 1},
+                {4, 3, 1},
+                {4, 4, 1},
+                {4, 6, 1},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 1},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 1},
+                {9, 8, 1},
+        });
+        thread_pool pool(4);
+        const bfs_result result = bfs_parallel(g, 1, pool);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 4" << std::endl;  // resources/digraph_unweighted.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {1, 3, 1},
+                {1, 4, 1},
+                {2, 5, 1},
+                {3, 5, 1},
+                {4, 3, 1},
+                {4, 4, 1},
+                {4, 6, 1},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 1},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 1},
+                {9, 8, 1},
+        });
+        const ms_bfs_result result = ms_bfs(g, {0, 1, 4, 5, 7});
+        display_distance_matrix(result);
+        // 200 sources (every vertex, several times) take four traversals.
+        std::vector<int> src_vertices;
+        for (int i = 0; i < 200; ++i) { src_vertices.push_back(i % 12); }
+        const ms_bfs_result many = ms_bfs(g, src_vertices);
+        bool same = true;
+        for (int i = 0; i < 200; ++i) {
+            const std::vector<double> row(many.dist.begin() + i * 12, many.dist.begin() + (i + 1) * 12);
+            same = same && row == bfs(g, src_vertices[i]).dist;
+        }
+        std::cout << "Same distances as 200 single source BFS: " << (same ? "yes" : "no") << std::endl;
+    }
+    std::cout << "Example 5" << std::endl;  // resources/digraph_unweighted.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {1, 3, 1},
+                {1, 4, 1},
+                {2, 5, 1},
+                {3, 5, 1},
+                {4, 3, 1},
+                {4, 4, 1},
+                {4, 6, 1},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 1},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 1},
+                {9, 8, 1},
+        });
+        // The workspace is allocated once and reused by every query.
+        bfs_workspace workspace(static_cast<int>(g.size()));
+        for (const int src_vertex: {1, 5}) {
+            const bfs_view result = bfs(g, src_vertex, workspace);
+            display_all_shortest_paths(result);
+        }
+    }
     return 0;
 }
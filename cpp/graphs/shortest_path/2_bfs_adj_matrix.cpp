@@ -1,12 +1,32 @@
 #include <algorithm>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <queue>
 #include <vector>
 
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 
-typedef std::vector<std::vector<double>> adj_matrix;
+// Adjacency matrix of a directed unweighted graph packed as bits: bit j of row i is set when the edge
+// (i, j) exists. Every row is padded to a whole number of 64-bit words, so a BFS step can test 64
+// candidate neighbors at once and the matrix takes V^2/8 bytes instead of 8V^2 with one 'double' per entry.
+class adj_bit_matrix {
+private:
+    int vertices;
+    int row_words;
+    std::vector<std::uint64_t> bits;
+public:
+    explicit adj_bit_matrix(int vertices)
+            : vertices(vertices), row_words((vertices + 63) / 64),
+              bits(static_cast<std::size_t>(vertices) * ((vertices + 63) / 64), 0) {}
+    std::size_t size() const { return vertices; }
+    int words() const { return row_words; }
+    const std::uint64_t *row(int vertex) const { return bits.data() + static_cast<std::size_t>(vertex) * row_words; }
+    void add_edge(int from, int to) {
+        bits[static_cast<std::size_t>(from) * row_words + (to >> 6)] |= std::uint64_t{1} << (to & 63);
+    }
+};
 
 struct bfs_result {
     const int src_vertex;
@@ -14,8 +34,9 @@ struct bfs_result {
     const std::vector<int> parent;
 };
 
-bfs_result bfs(const adj_matrix &m, int src_vertex) {
+bfs_result bfs(const adj_bit_matrix &m, int src_vertex) {
     const int vertices = static_cast<int>(m.size());
+    const int words = m.words();
     // Initialize the distance to all vertices to be infinity except for the start vertex which is zero.
     // dist[i] is the current shortest distance from 'src_vertex' to vertex i.
     std::vector<double> dist(vertices, POSITIVE_INFINITY);
@@ -23,17 +44,23 @@ bfs_result bfs(const adj_matrix &m, int src_vertex) {
     // This array will allows for shortest path reconstruction (if required) after the algorithm has terminated.
     // parent[i] is the vertex where vertex i comes from in the shortest path.
     std::vector<int> parent(vertices, -1);
+    // Bitset of the vertices already visited, with the same layout as a row of the matrix.
+    std::vector<std::uint64_t> visited(words, 0);
+    visited[src_vertex >> 6] |= std::uint64_t{1} << (src_vertex & 63);
     // Start by visiting 'src_vertex' and add it to the queue.
     std::queue<int> q;
     q.push(src_vertex);
 
     while (!q.empty()) {
         const int vertex = q.front(); q.pop();
-        for (int i = 0; i < vertices; ++i) {
-            // Ignoring invalid edges.
-            if (m[vertex][i] == POSITIVE_INFINITY) { continue; }
-            // We enqueue only the unvisited neighboring vertices.
-            if (dist[i] == POSITIVE_INFINITY) {
+        const std::uint64_t *row = m.row(vertex);
+        for (int w = 0; w < words; ++w) {
+            // The unvisited neighboring vertices among the 64 vertices covered by this word, all of which
+            // are enqueued in increasing order. 'next &= next - 1' clears the lowest set bit.
+            std::uint64_t next = row[w] & ~visited[w];
+            visited[w] |= next;
+            for (; next != 0; next &= next - 1) {
+                const int i = (w << 6) + __builtin_ctzll(next);
                 dist[i] = dist[vertex] + 1;
                 q.push(i);
                 parent[i] = vertex;
@@ -50,16 +77,6 @@ bfs_result bfs(const adj_matrix &m, int src_vertex) {
     return {src_vertex, dist, parent};
 }
 
-adj_matrix setup_disconnected_adjacency_matrix(int vertices) {
-    // Fill all edges with infinity by default.
-    adj_matrix result(vertices, std::vector<double>(vertices, POSITIVE_INFINITY));
-    // Assuming the distance for a vertex to reach itself is 0.
-    for (int i = 0; i < vertices; ++i) {
-        result[i][i] = 0;
-    }
-    return result;
-}
-
 void display_shortest_path(const bfs_result &result, int dest_vertex) {
     std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
               << std::setw(4) << result.dist[dest_vertex] << "] ";
@@ -90,24 +107,24 @@ void display_all_shortest_paths(const bfs_result &result) {
 int main() {
     std::cout << "Example 1" << std::endl;  // resources/digraph_unweighted.svg
     {
-        adj_matrix m = setup_disconnected_adjacency_matrix(12);
-        m[0][1] = 1;
-        m[1][2] = 1;
-        m[1][3] = 1;
-        m[1][4] = 1;
-        m[2][5] = 1;
-        m[3][5] = 1;
-        m[4][3] = 1;
-        m[4][4] = 1;
-        m[4][6] = 1;
-        m[5][2] = 1;
-        m[5][6] = 1;
-        m[5][7] = 1;
-        m[6][9] = 1;
-        m[7][8] = 1;
-        m[7][10] = 1;
-        m[8][6] = 1;
-        m[9][8] = 1;
+        adj_bit_matrix m(12);
+        m.add_edge(0, 1);
+        m.add_edge(1, 2);
+        m.add_edge(1, 3);
+        m.add_edge(1, 4);
+        m.add_edge(2, 5);
+        m.add_edge(3, 5);
+        m.add_edge(4, 3);
+        m.add_edge(4, 4);
+        m.add_edge(4, 6);
+        m.add_edge(5, 2);
+        m.add_edge(5, 6);
+        m.add_edge(5, 7);
+        m.add_edge(6, 9);
+        m.add_edge(7, 8);
+        m.add_edge(7, 10);
+        m.add_edge(8, 6);
+        m.add_edge(9, 8);
         const bfs_result result = bfs(m, 1);
         display_all_shortest_paths(result);
     }
@@ -1,30 +1,12 @@
 #include <algorithm>
-#include <cassert>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <vector>
 
-constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
-
-// Directed edge with a cost.
-struct edge {
-    const int from, to;
-    const double cost;
-};
+#include "../csr_graph.h"
 
-// Directed graph with adjacency lists.
-class graph {
-private:
-    std::vector<std::vector<edge>> adj_lists;
-public:
-    explicit graph(int vertices) : adj_lists(vertices, std::vector<edge>()) {}
-    std::size_t size() const { return adj_lists.size(); }
-    const std::vector<edge> &adj_list(int vertex) const { return adj_lists[vertex]; }
-    void add_edge(int vertex, const edge &e) {
-        assert(vertex == e.from);
-        adj_lists[vertex].push_back(e);
-    }
-};
+constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 
 struct dijkstra_result {
     const int src_vertex;
@@ -32,7 +14,7 @@ struct dijkstra_result {
     const std::vector<int> parent;
 };
 
-dijkstra_result dijkstra(const graph &graph, int src_vertex) {
+dijkstra_result dijkstra(const csr_graph &graph, int src_vertex) {
     const int vertices = static_cast<int>(graph.size());
     // Initialize the distance to all vertices to be infinity except for the start vertex which is zero.
     // dist[i] is the current shortest distance from 'src_vertex' to vertex i.
@@ -53,11 +35,11 @@ dijkstra_result dijkstra(const graph &graph, int src_vertex) {
         visited[min_vertex] = true;
         // For each vertex from 'vertex', apply relaxation for all the edges, except those already visited,
         // because this means that they already have the best possible distance.
-        for (const auto &edge: graph.adj_list(min_vertex)) {
+        for (const auto edge: graph.adj_list(min_vertex)) {
             if (visited[edge.to]) { continue; }
-            if (dist[edge.from] + edge.cost < dist[edge.to]) {
-                dist[edge.to] = dist[edge.from] + edge.cost;
-                parent[edge.to] = edge.from;
+            if (dist[min_vertex] + edge.cost < dist[edge.to]) {
+                dist[edge.to] = dist[min_vertex] + edge.cost;
+                parent[edge.to] = min_vertex;
             }
         }
 
@@ -113,41 +95,43 @@ void display_all_shortest_paths(const dijkstra_result &result) {
 int main() {
     std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
     {
-        graph g(6);
-        g.add_edge(0, {0, 1, 5});
-        g.add_edge(0, {0, 2, 1});
-        g.add_edge(1, {1, 2, 2});
-        g.add_edge(1, {1, 3, 3});
-        g.add_edge(1, {1, 4, 20});
-        g.add_edge(2, {2, 1, 3});
-        g.add_edge(2, {2, 4, 12});
-        g.add_edge(3, {3, 2, 3});
-        g.add_edge(3, {3, 4, 2});
-        g.add_edge(3, {3, 5, 6});
-        g.add_edge(4, {4, 5, 1});
+        const csr_graph g(6, {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        });
         const dijkstra_result result = dijkstra(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 2" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
     {
-        graph g(12);
-        g.add_edge(0, {0, 1, 1});
-        g.add_edge(1, {1, 2, 8});
-        g.add_edge(1, {1, 3, 4});
-        g.add_edge(1, {1, 4, 1});
-        g.add_edge(2, {2, 5, 2});
-        g.add_edge(3, {3, 5, 2});
-        g.add_edge(4, {4, 3, 2});
-        g.add_edge(4, {4, 4, 3});
-        g.add_edge(4, {4, 6, 6});
-        g.add_edge(5, {5, 2, 1});
-        g.add_edge(5, {5, 6, 1});
-        g.add_edge(5, {5, 7, 2});
-        g.add_edge(6, {6, 9, 1});
-        g.add_edge(7, {7, 8, 1});
-        g.add_edge(7, {7, 10, 1});
-        g.add_edge(8, {8, 6, 3});
-        g.add_edge(9, {9, 8, 2});
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
         const dijkstra_result result = dijkstra(g, 1);
         display_all_shortest_paths(result);
     }
@@ -1,39 +1,61 @@
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
-#include <queue>
+#include <limits>
+#include <utility>
 #include <vector>
 
+#include "../csr_graph.h"
+#include "../priority_queues.h"
+#include "../stamped_array.h"
+#include "../thread_pool.h"
+
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 
-// Directed edge with a cost.
-struct edge {
-    const int from, to;
-    const double cost;
+struct dijkstra_result {
+    const int src_vertex;
+    const std::vector<double> dist;
+    const std::vector<int> parent;
 };
 
-// Directed graph with adjacency lists.
-class graph {
-private:
-    std::vector<std::vector<edge>> adj_lists;
-public:
-    explicit graph(int vertices) : adj_lists(vertices, std::vector<edge>()) {}
-    std::size_t size() const { return adj_lists.size(); }
-    const std::vector<edge> &adj_list(int vertex) const { return adj_lists[vertex]; }
-    void add_edge(int vertex, const edge &e) {
-        assert(vertex == e.from);
-        adj_lists[vertex].push_back(e);
-    }
+// Memory kept by the caller across many queries of 'dijkstra' on the same graph, so that a query does not
+// allocate nor initialize anything of size V. The labels are reset through their generation stamps, and the
+// queue is always left empty by a finished search.
+template<typename PriorityQueue = indexed_dary_heap<4>>
+struct dijkstra_workspace {
+    stamped_array<double> dist;
+    stamped_array<int> parent;
+    PriorityQueue pq;
+    explicit dijkstra_workspace(int vertices) : dist(vertices, POSITIVE_INFINITY), parent(vertices, -1), pq(vertices) {}
 };
 
-struct dijkstra_result {
+// Result of a query run on a workspace. It refers to the arrays of the workspace instead of copying them, so
+// it is only valid until the next query on the same workspace.
+struct dijkstra_view {
     const int src_vertex;
+    const stamped_array<double> &dist;
+    const stamped_array<int> &parent;
+};
+
+struct distance_table_result {
+    const std::vector<int> src_vertices;
+    const std::vector<int> dest_vertices;
+    // Row-major |src_vertices| x |dest_vertices| matrix, dist[i * |dest_vertices| + j] is the distance from
+    // 'src_vertices[i]' to 'dest_vertices[j]'.
     const std::vector<double> dist;
-    const std::vector<int> parent;
 };
 
-dijkstra_result dijkstra(const graph &graph, int src_vertex) {
+// Largest edge weight for which 'dijkstra_integer' picks Dial's bucket queue over the radix heap.
+constexpr std::uint64_t DIAL_MAX_WEIGHT = 1024;
+
+// 'PriorityQueue' is any of the queues from priority_queues.h. The default indexed 4-ary heap supports a real
+// decrease-key, so it never holds more than V entries, while 'lazy_priority_queue' (the STL binary heap with
+// lazy deletion) can grow up to O(E) entries but is kept selectable for comparison.
+template<typename PriorityQueue = indexed_dary_heap<4>>
+dijkstra_result dijkstra(const csr_graph &graph, int src_vertex) {
     const int vertices = static_cast<int>(graph.size());
     // Initialize the distance to all vertices to be infinity except for the start vertex which is zero.
     // dist[i] is the current shortest distance from 'src_vertex' to vertex i.
@@ -46,32 +68,32 @@ dijkstra_result dijkstra(const graph &graph, int src_vertex) {
     std::vector<bool> visited(vertices, false);
     // Keep a priority queue of the next most promising vertex to visit, which is the unvisited one with the
     // shortest distance. We start with 'src_vertex'.
-    typedef std::pair<double, int> pq_entry;
-    std::priority_queue<pq_entry, std::vector<pq_entry>, std::greater<>> pq;
-    pq.push({0, src_vertex});
+    PriorityQueue pq(vertices);
+    pq.push(src_vertex, 0);
 
     while (!pq.empty()) {
-        const double distance = pq.top().first;
-        const int vertex = pq.top().second;
+        const double distance = pq.top_key();
+        const int vertex = pq.top();
         pq.pop();
         visited[vertex] = true;
         // The usual implementation of Dijkstra’s requires heapDecreaseKey operation in binary heap data
-        // structure that is not supported by priority queue in STL, so every time we update the distance
-        // to a vertex, we enqueue a pair (newer/shorter distance, vertex) into pq and leave the inferior
-        // pair (older/longer distance, vertex) inside pq, This is called 'Lazy Deletion' and it causes more
-        // than one copy of the same vertex in pq with different distances from source. That is why we have
-        // the check earlier to process only the first dequeued vertex information pair which has the
-        // correct/shorter distance (other copies will have the outdated/longer distance). This is no ideal,
-        // but inserting a new pair in O(log(n)) is much faster than searching for the key in the pq in O(n).
+        // structure that is not supported by priority queue in STL, so with 'lazy_priority_queue' every time
+        // we update the distance to a vertex, we enqueue a pair (newer/shorter distance, vertex) into pq and
+        // leave the inferior pair (older/longer distance, vertex) inside pq, This is called 'Lazy Deletion'
+        // and it causes more than one copy of the same vertex in pq with different distances from source.
+        // That is why we have the check earlier to process only the first dequeued vertex information pair
+        // which has the correct/shorter distance (other copies will have the outdated/longer distance). With
+        // 'indexed_dary_heap' every vertex is in the queue at most once with its current distance, so this
+        // check never skips anything.
         if (distance > dist[vertex]) { continue; }
         // For each vertex from 'vertex', apply relaxation for all the edges, except those already visited,
         // because this means that they already have the best possible distance.
-        for (const auto &edge: graph.adj_list(vertex)) {
+        for (const auto edge: graph.adj_list(vertex)) {
             if (visited[edge.to]) { continue; }
-            if (dist[edge.from] + edge.cost < dist[edge.to]) {
-                dist[edge.to] = dist[edge.from] + edge.cost;
-                pq.push({dist[edge.to], edge.to});
-                parent[edge.to] = edge.from;
+            if (dist[vertex] + edge.cost < dist[edge.to]) {
+                dist[edge.to] = dist[vertex] + edge.cost;
+                pq.push(edge.to, dist[edge.to]);
+                parent[edge.to] = vertex;
             }
         }
         // If we are trying to solve 'Single Pair Shortest Path (SPSP)' we can add a new function parameter
@@ -80,12 +102,160 @@ dijkstra_result dijkstra(const graph &graph, int src_vertex) {
         // But if we want just to return the shortest distance we can make a 'return dist[dest_vertex]' at
         // at this point, also putting a 'return POSITIVE_INFINITY' at the end of the function, instead of
         // returning a 'dijkstra_result', which means that 'dest_vertex' is not reachable from 'src_vertex'.
+        // A faster alternative for SPSP is the bidirectional search in '12_bidirectional_dijkstra_adj_list.cpp'.
+    }
+
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Same search on the memory of 'workspace', for high query rates on a large graph. Resetting the labels is
+// O(1) and every query only costs the vertices it reaches. There is no 'visited' array: a settled vertex can
+// never be improved again with non-negative weights, and outdated queue entries are skipped by the distance
+// check as in the function above.
+template<typename PriorityQueue>
+dijkstra_view dijkstra(const csr_graph &graph, int src_vertex, dijkstra_workspace<PriorityQueue> &workspace) {
+    assert(workspace.dist.size() == graph.size() && workspace.pq.empty());
+    stamped_array<double> &dist = workspace.dist;
+    stamped_array<int> &parent = workspace.parent;
+    PriorityQueue &pq = workspace.pq;
+    dist.reset();
+    parent.reset();
+    dist.set(src_vertex, 0);
+    pq.push(src_vertex, 0);
+
+    while (!pq.empty()) {
+        const double distance = pq.top_key();
+        const int vertex = pq.top();
+        pq.pop();
+        if (distance > dist[vertex]) { continue; }
+        for (const auto edge: graph.adj_list(vertex)) {
+            const double new_distance = distance + edge.cost;
+            if (new_distance < dist[edge.to]) {
+                dist.set(edge.to, new_distance);
+                pq.push(edge.to, new_distance);
+                parent.set(edge.to, vertex);
+            }
+        }
     }
 
     return {src_vertex, dist, parent};
 }
 
-void display_shortest_path(const dijkstra_result &result, int dest_vertex) {
+// Many-to-many distances: one Dijkstra per source, run in parallel on the threads of 'pool' with a workspace
+// per thread. Each search stops as soon as all the destinations are settled instead of exploring the whole
+// graph, which pays off when the destinations are close to each other (e.g. the depots and customers of a
+// city). Every row is filled by a single thread, so the table is the same for any number of threads. Given a
+// 'contraction_hierarchy', the bucket-based version in '14_contraction_hierarchies_adj_list.cpp' is faster.
+distance_table_result distance_table(const csr_graph &graph, const std::vector<int> &src_vertices,
+                                     const std::vector<int> &dest_vertices, thread_pool &pool) {
+    const int vertices = static_cast<int>(graph.size());
+    const std::size_t columns = dest_vertices.size();
+    // is_dest[i] tells whether vertex i is a destination, which is counted once even if it is repeated.
+    std::vector<char> is_dest(vertices, false);
+    int dest_count = 0;
+    for (const int dest_vertex: dest_vertices) {
+        if (!is_dest[dest_vertex]) {
+            is_dest[dest_vertex] = true;
+            ++dest_count;
+        }
+    }
+    std::vector<double> dist(src_vertices.size() * columns, POSITIVE_INFINITY);
+    std::vector<dijkstra_workspace<>> workspaces;
+    workspaces.reserve(pool.size());
+    for (int thread_id = 0; thread_id < pool.size(); ++thread_id) {
+        workspaces.emplace_back(vertices);
+    }
+
+    pool.parallel_for(0, static_cast<long long>(src_vertices.size()), 1, [&](int thread_id, long long i) {
+        dijkstra_workspace<> &workspace = workspaces[thread_id];
+        workspace.dist.reset();
+        workspace.dist.set(src_vertices[i], 0);
+        workspace.pq.push(src_vertices[i], 0);
+        for (int remaining = dest_count; remaining > 0 && !workspace.pq.empty();) {
+            const double distance = workspace.pq.top_key();
+            const int vertex = workspace.pq.top();
+            workspace.pq.pop();
+            if (is_dest[vertex]) { --remaining; }
+            for (const auto edge: graph.adj_list(vertex)) {
+                if (distance + edge.cost < workspace.dist[edge.to]) {
+                    workspace.dist.set(edge.to, distance + edge.cost);
+                    workspace.pq.push(edge.to, distance + edge.cost);
+                }
+            }
+        }
+        // The search may have stopped with vertices still in the queue.
+        workspace.pq.clear();
+        for (std::size_t j = 0; j < columns; ++j) {
+            dist[i * columns + j] = workspace.dist[dest_vertices[j]];
+        }
+    });
+
+    return {src_vertices, dest_vertices, std::move(dist)};
+}
+
+// Dijkstra for graphs whose edge weights are non-negative integers (e.g. travel times in seconds). Distances
+// are computed as exact integers, and since the keys popped from the queue never decrease, a monotone integer
+// queue from priority_queues.h ('radix_heap' or 'bucket_queue') can replace the comparison based heap and its
+// log(V) factor. Both use lazy deletion, so outdated entries are skipped as in 'lazy_priority_queue'.
+template<typename IntegerPriorityQueue>
+dijkstra_result dijkstra_integer(const csr_graph &graph, int src_vertex, std::uint64_t max_weight) {
+    constexpr std::uint64_t INTEGER_INFINITY = std::numeric_limits<std::uint64_t>::max();
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<std::uint64_t> dist(vertices, INTEGER_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+    IntegerPriorityQueue pq(vertices, max_weight);
+    pq.push(src_vertex, 0);
+
+    while (!pq.empty()) {
+        const std::uint64_t distance = pq.top_key();
+        const int vertex = pq.top();
+        pq.pop();
+        if (distance > dist[vertex]) { continue; }
+        for (const auto edge: graph.adj_list(vertex)) {
+            assert(edge.cost >= 0 && edge.cost <= max_weight && edge.cost == static_cast<std::uint64_t>(edge.cost));
+            const std::uint64_t new_distance = distance + static_cast<std::uint64_t>(edge.cost);
+            if (new_distance < dist[edge.to]) {
+                dist[edge.to] = new_distance;
+                pq.push(edge.to, new_distance);
+                parent[edge.to] = vertex;
+            }
+        }
+    }
+
+    // Same 'dijkstra_result' as the floating point version, with POSITIVE_INFINITY for unreachable vertices.
+    std::vector<double> result_dist(vertices, POSITIVE_INFINITY);
+    for (int i = 0; i < vertices; ++i) {
+        if (dist[i] != INTEGER_INFINITY) { result_dist[i] = static_cast<double>(dist[i]); }
+    }
+    return {src_vertex, std::move(result_dist), std::move(parent)};
+}
+
+// Chooses the integer queue from the maximum edge weight C: Dial's buckets run in O(V*C + E), which is the
+// fastest option while C is small, and the radix heap runs in O(E + V*log(C)) for any C. If some cost is not
+// a non-negative integer (up to 2^53, the largest one a double holds exactly), the integer queues would give
+// wrong distances, so it falls back to the floating point 'dijkstra'.
+dijkstra_result dijkstra_integer(const csr_graph &graph, int src_vertex) {
+    constexpr double MAX_EXACT_INTEGER = 9007199254740992.0;
+    std::uint64_t max_weight = 0;
+    for (int vertex = 0; vertex < static_cast<int>(graph.size()); ++vertex) {
+        for (const auto edge: graph.adj_list(vertex)) {
+            // Also false for NaN.
+            if (!(edge.cost >= 0 && edge.cost <= MAX_EXACT_INTEGER && edge.cost == std::floor(edge.cost))) {
+                return dijkstra(graph, src_vertex);
+            }
+            max_weight = std::max(max_weight, static_cast<std::uint64_t>(edge.cost));
+        }
+    }
+    if (max_weight <= DIAL_MAX_WEIGHT) {
+        return dijkstra_integer<bucket_queue>(graph, src_vertex, max_weight);
+    }
+    return dijkstra_integer<radix_heap>(graph, src_vertex, max_weight);
+}
+
+// 'Result' is either a 'dijkstra_result' or a 'dijkstra_view'.
+template<typename Result>
+void display_shortest_path(const Result &result, int dest_vertex) {
     std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
               << std::setw(4) << result.dist[dest_vertex] << "] ";
     if (result.dist[dest_vertex] == POSITIVE_INFINITY) {
@@ -105,53 +275,197 @@ void display_shortest_path(const dijkstra_result &result, int dest_vertex) {
     std::cout << std::endl;
 }
 
-void display_all_shortest_paths(const dijkstra_result &result) {
+template<typename Result>
+void display_all_shortest_paths(const Result &result) {
     const int vertices = static_cast<int>(result.dist.size());
     for (int dest_vertex = 0; dest_vertex < vertices; ++dest_vertex) {
         display_shortest_path(result, dest_vertex);
     }
 }
 
+void display_distance_table(const distance_table_result &result) {
+    const std::size_t columns = result.dest_vertices.size();
+    std::cout << "        ";
+    for (const int dest_vertex: result.dest_vertices) {
+        std::cout << " " << std::setw(4) << dest_vertex;
+    }
+    std::cout << std::endl;
+    for (std::size_t i = 0; i < result.src_vertices.size(); ++i) {
+        std::cout << "From " << std::setw(2) << result.src_vertices[i] << ":";
+        for (std::size_t j = 0; j < columns; ++j) {
+            std::cout << " " << std::setw(4) << result.dist[i * columns + j];
+        }
+        std::cout << std::endl;
+    }
+}
+
 int main() {
     std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
     {
-        graph g(6);
-        g.add_edge(0, {0, 1, 5});
-        g.add_edge(0, {0, 2, 1});
-        g.add_edge(1, {1, 2, 2});
-        g.add_edge(1, {1, 3, 3});
-        g.add_edge(1, {1, 4, 20});
-        g.add_edge(2, {2, 1, 3});
-        g.add_edge(2, {2, 4, 12});
-        g.add_edge(3, {3, 2, 3});
-        g.add_edge(3, {3, 4, 2});
-        g.add_edge(3, {3, 5, 6});
-        g.add_edge(4, {4, 5, 1});
+        const csr_graph g(6, {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        });
         const dijkstra_result result = dijkstra(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 2" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
     {
-        graph g(12);
-        g.add_edge(0, {0, 1, 1});
-        g.add_edge(1, {1, 2, 8});
-        g.add_edge(1, {1, 3, 4});
-        g.add_edge(1, {1, 4, 1});
-        g.add_edge(2, {2, 5, 2});
-        g.add_edge(3, {3, 5, 2});
-        g.add_edge(4, {4, 3, 2});
-        g.add_edge(4, {4, 4, 3});
-        g.add_edge(4, {4, 6, 6});
-        g.add_edge(5, {5, 2, 1});
-        g.add_edge(5, {5, 6, 1});
-        g.add_edge(5, {5, 7, 2});
-        g.add_edge(6, {6, 9, 1});
-        g.add_edge(7, {7, 8, 1});
-        g.add_edge(7, {7, 10, 1});
-        g.add_edge(8, {8, 6, 3});
-        g.add_edge(9, {9, 8, 2});
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
         const dijkstra_result result = dijkstra(g, 1);
         display_all_shortest_paths(result);
     }
+    std::cout << "Example 3" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const dijkstra_result result = dijkstra<lazy_priority_queue>(g, 1);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 4" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const dijkstra_result result = dijkstra_integer(g, 1);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 5" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        const dijkstra_result result = dijkstra_integer<radix_heap>(g, 1, 8);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 6" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        // The workspace is allocated once and reused by every query.
+        dijkstra_workspace<> workspace(static_cast<int>(g.size()));
+        for (const int src_vertex: {1, 5}) {
+            const dijkstra_view result = dijkstra(g, src_vertex, workspace);
+            display_all_shortest_paths(result);
+        }
+    }
+    std::cout << "Example 7" << std::endl;  // resources/digraph_weighted_no_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, 2},
+        });
+        thread_pool pool(4);
+        const distance_table_result result = distance_table(g, {0, 1, 4, 5, 7}, {2, 6, 8, 10, 11}, pool);
+        display_distance_table(result);
+    }
     return 0;
 }
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
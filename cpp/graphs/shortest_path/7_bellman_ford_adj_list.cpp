@@ -1,39 +1,23 @@
 #include <algorithm>
-#include <cassert>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <queue>
+#include <utility>
 #include <vector>
 
+#include "../csr_graph.h"
+
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 constexpr double NEGATIVE_INFINITY = -POSITIVE_INFINITY;
 
-// Directed edge with a cost.
-struct edge {
-    const int from, to;
-    const double cost;
-};
-
-// Directed graph with adjacency lists.
-class graph {
-private:
-    std::vector<std::vector<edge>> adj_lists;
-public:
-    explicit graph(int vertices) : adj_lists(vertices, std::vector<edge>()) {}
-    std::size_t size() const { return adj_lists.size(); }
-    const std::vector<edge> &adj_list(int vertex) const { return adj_lists[vertex]; }
-    void add_edge(int vertex, const edge &e) {
-        assert(vertex == e.from);
-        adj_lists[vertex].push_back(e);
-    }
-};
-
 struct bellman_ford_result {
     const int src_vertex;
     const std::vector<double> dist;
     const std::vector<int> parent;
 };
 
-bellman_ford_result bellman_ford(const graph &graph, int src_vertex) {
+bellman_ford_result bellman_ford(const csr_graph &graph, int src_vertex) {
     const int vertices = static_cast<int>(graph.size());
     // Initialize the distance to all vertices to be infinity except for the start vertex which is zero.
     // dist[i] is the current shortest distance from 'src_vertex' to vertex i.
@@ -51,10 +35,10 @@ bellman_ford_result bellman_ford(const graph &graph, int src_vertex) {
     for (int _ = 0; _ < vertices - 1 && some_edge_relaxed; ++_) {
         some_edge_relaxed = false;
         for (int i = 0; i < vertices; ++i) {
-            for (const auto & edge: graph.adj_list(i)) {
-                if (dist[edge.from] + edge.cost < dist[edge.to]) {
-                    dist[edge.to] = dist[edge.from] + edge.cost;
-                    parent[edge.to] = edge.from;
+            for (const auto edge: graph.adj_list(i)) {
+                if (dist[i] + edge.cost < dist[edge.to]) {
+                    dist[edge.to] = dist[i] + edge.cost;
+                    parent[edge.to] = i;
                     some_edge_relaxed = true;
                 }
             }
@@ -69,8 +53,8 @@ bellman_ford_result bellman_ford(const graph &graph, int src_vertex) {
     for (int _ = 0; _ < vertices - 1 && some_edge_relaxed; ++_) {
         some_edge_relaxed = false;
         for (int i = 0; i < vertices; ++i) {
-            for (const auto &edge: graph.adj_list(i)) {
-                if (dist[edge.from] + edge.cost < dist[edge.to]) {
+            for (const auto edge: graph.adj_list(i)) {
+                if (dist[i] + edge.cost < dist[edge.to]) {
                     dist[edge.to] = NEGATIVE_INFINITY;
                     parent[edge.to] = -1;
                     some_edge_relaxed = true;
@@ -79,7 +63,91 @@ bellman_ford_result bellman_ford(const graph &graph, int src_vertex) {
         }
     }
 
-    return {src_vertex, dist, parent};
+    return {src_vertex, std::move(dist), std::move(parent)};
+}
+
+// Queue-based Bellman-Ford (also known as SPFA) with Tarjan's 'subtree disassembly' (1981). Instead of
+// sweeping every edge in each round, only the vertices whose distance changed are put in a FIFO queue and
+// scanned. The parents form a shortest path tree, kept as a list of its vertices in preorder with their depth,
+// so the subtree of a vertex is the run of vertices after it with a greater depth. When the distance of v
+// improves, every descendant of v holds an outdated distance that will improve again, so the whole subtree is
+// removed from the tree and from the queue, which saves many useless scans. If the edge u -> v being relaxed
+// starts inside the subtree of v, then the tree path v ~> u plus that edge is a negative cycle: it is found as
+// soon as it appears in the tree, instead of after V-1 rounds. Such a vertex v is 'frozen' (never scanned nor
+// improved again) so the search finishes on the rest of the graph, and a single BFS from the frozen vertices
+// marks with NEGATIVE_INFINITY everything they reach. The result is the same as the one of 'bellman_ford'
+// (parents may differ among equally short alternatives).
+bellman_ford_result bellman_ford_queue(const csr_graph &graph, int src_vertex) {
+    const int vertices = static_cast<int>(graph.size());
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+    // Shortest path tree in preorder as a doubly linked list. depth[i] == -1 means that vertex i is not in it.
+    std::vector<int> next(vertices, -1), prev(vertices, -1), depth(vertices, -1);
+    depth[src_vertex] = 0;
+    // in_queue[i] is false for vertices removed from the queue by a disassembly, which are skipped when popped.
+    std::vector<bool> in_queue(vertices, false), frozen(vertices, false);
+    std::queue<int> q;
+    q.push(src_vertex);
+    in_queue[src_vertex] = true;
+
+    while (!q.empty()) {
+        const int vertex = q.front(); q.pop();
+        if (!in_queue[vertex] || frozen[vertex]) { continue; }
+        in_queue[vertex] = false;
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (frozen[edge.to] || dist[vertex] + edge.cost >= dist[edge.to]) { continue; }
+            // Remove the subtree of 'edge.to' (but 'edge.to' itself) from the tree and from the queue.
+            bool negative_cycle = edge.to == vertex;
+            int after = depth[edge.to] == -1 ? -1 : next[edge.to];
+            for (; after != -1 && depth[after] > depth[edge.to]; after = next[after]) {
+                negative_cycle = negative_cycle || after == vertex;
+                depth[after] = -1;
+                in_queue[after] = false;
+            }
+            if (depth[edge.to] != -1) {
+                // Unlink 'edge.to' and its subtree, which are the vertices between it and 'after'.
+                if (prev[edge.to] != -1) { next[prev[edge.to]] = after; }
+                if (after != -1) { prev[after] = prev[edge.to]; }
+            }
+            if (negative_cycle) {
+                // 'vertex' was just removed with the subtree, so this scan stops here.
+                depth[edge.to] = -1;
+                frozen[edge.to] = true;
+                break;
+            }
+            dist[edge.to] = dist[vertex] + edge.cost;
+            parent[edge.to] = vertex;
+            // Link 'edge.to' as the first child of 'vertex'.
+            depth[edge.to] = depth[vertex] + 1;
+            prev[edge.to] = vertex;
+            next[edge.to] = next[vertex];
+            if (next[vertex] != -1) { prev[next[vertex]] = edge.to; }
+            next[vertex] = edge.to;
+            if (!in_queue[edge.to]) {
+                in_queue[edge.to] = true;
+                q.push(edge.to);
+            }
+        }
+    }
+
+    // Everything reachable from a frozen vertex is reachable from a negative cycle.
+    for (int i = 0; i < vertices; ++i) {
+        if (frozen[i]) { q.push(i); }
+    }
+    while (!q.empty()) {
+        const int vertex = q.front(); q.pop();
+        dist[vertex] = NEGATIVE_INFINITY;
+        parent[vertex] = -1;
+        for (const auto edge: graph.adj_list(vertex)) {
+            if (!frozen[edge.to]) {
+                frozen[edge.to] = true;
+                q.push(edge.to);
+            }
+        }
+    }
+
+    return {src_vertex, std::move(dist), std::move(parent)};
 }
 
 void display_shortest_path(const bellman_ford_result &result, int dest_vertex) {
@@ -114,94 +182,124 @@ void display_all_shortest_paths(const bellman_ford_result &result) {
 int main() {
     std::cout << "Example 1" << std::endl;  // https://www.youtube.com/watch?v=pSqmAO-m7Lk (graph example 2)
     {
-        graph g(6);
-        g.add_edge(0, {0, 1, 5});
-        g.add_edge(0, {0, 2, 1});
-        g.add_edge(1, {1, 2, 2});
-        g.add_edge(1, {1, 3, 3});
-        g.add_edge(1, {1, 4, 20});
-        g.add_edge(2, {2, 1, 3});
-        g.add_edge(2, {2, 4, 12});
-        g.add_edge(3, {3, 2, 3});
-        g.add_edge(3, {3, 4, 2});
-        g.add_edge(3, {3, 5, 6});
-        g.add_edge(4, {4, 5, 1});
+        const csr_graph g(6, {
+                {0, 1, 5},
+                {0, 2, 1},
+                {1, 2, 2},
+                {1, 3, 3},
+                {1, 4, 20},
+                {2, 1, 3},
+                {2, 4, 12},
+                {3, 2, 3},
+                {3, 4, 2},
+                {3, 5, 6},
+                {4, 5, 1},
+        });
         const bellman_ford_result result = bellman_ford(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 2" << std::endl;  // https://www.youtube.com/watch?v=lyw4FaxrwHg (graph example 1)
     {
-        graph g(7);
-        g.add_edge(0, {0, 1, 4});
-        g.add_edge(0, {0, 6, 2});
-        g.add_edge(1, {1, 1, -1});
-        g.add_edge(1, {1, 2, 3});
-        g.add_edge(2, {2, 3, 3});
-        g.add_edge(2, {2, 4, 1});
-        g.add_edge(3, {3, 5, -2});
-        g.add_edge(4, {4, 5, 2});
-        g.add_edge(6, {6, 4, 2});
+        const csr_graph g(7, {
+                {0, 1, 4},
+                {0, 6, 2},
+                {1, 1, -1},
+                {1, 2, 3},
+                {2, 3, 3},
+                {2, 4, 1},
+                {3, 5, -2},
+                {4, 5, 2},
+                {6, 4, 2},
+        });
         const bellman_ford_result result = bellman_ford(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 3" << std::endl;  // https://www.youtube.com/watch?v=lyw4FaxrwHg (graph example 2)
     {
-        graph g(10);
-        g.add_edge(0, {0, 1, 5});
-        g.add_edge(1, {1, 2, 20});
-        g.add_edge(1, {1, 5, 30});
-        g.add_edge(1, {1, 6, 60});
-        g.add_edge(2, {2, 3, 10});
-        g.add_edge(2, {2, 4, 75});
-        g.add_edge(3, {3, 2, -15});
-        g.add_edge(4, {4, 9, 100});
-        g.add_edge(5, {5, 4, 25});
-        g.add_edge(5, {5, 6, 5});
-        g.add_edge(5, {5, 8, 50});
-        g.add_edge(6, {6, 7, -50});
-        g.add_edge(7, {7, 8, -10});
+        const csr_graph g(10, {
+                {0, 1, 5},
+                {1, 2, 20},
+                {1, 5, 30},
+                {1, 6, 60},
+                {2, 3, 10},
+                {2, 4, 75},
+                {3, 2, -15},
+                {4, 9, 100},
+                {5, 4, 25},
+                {5, 6, 5},
+                {5, 8, 50},
+                {6, 7, -50},
+                {7, 8, -10},
+        });
         const bellman_ford_result result = bellman_ford(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 4" << std::endl;  // https://www.youtube.com/watch?v=lyw4FaxrwHg (graph example 3 from github)
     {
-        graph g(9);
-        g.add_edge(0, {0, 1, 1});
-        g.add_edge(1, {1, 2, 1});
-        g.add_edge(2, {2, 4, 1});
-        g.add_edge(4, {4, 3, -3});
-        g.add_edge(3, {3, 2, 1});
-        g.add_edge(1, {1, 5, 4});
-        g.add_edge(1, {1, 6, 4});
-        g.add_edge(5, {5, 6, 5});
-        g.add_edge(6, {6, 7, 4});
-        g.add_edge(5, {5, 7, 3});
+        const csr_graph g(9, {
+                {0, 1, 1},
+                {1, 2, 1},
+                {2, 4, 1},
+                {4, 3, -3},
+                {3, 2, 1},
+                {1, 5, 4},
+                {1, 6, 4},
+                {5, 6, 5},
+                {6, 7, 4},
+                {5, 7, 3},
+        });
         const bellman_ford_result result = bellman_ford(g, 0);
         display_all_shortest_paths(result);
     }
     std::cout << "Example 5" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
     {
-        graph g(12);
-        g.add_edge(0, {0, 1, 1});
-        g.add_edge(1, {1, 2, 8});
-        g.add_edge(1, {1, 3, 4});
-        g.add_edge(1, {1, 4, 1});
-        g.add_edge(2, {2, 5, 2});
-        g.add_edge(3, {3, 5, 2});
-        g.add_edge(4, {4, 3, 2});
-        g.add_edge(4, {4, 4, 3});
-        g.add_edge(4, {4, 6, 6});
-        g.add_edge(5, {5, 2, 1});
-        g.add_edge(5, {5, 6, 1});
-        g.add_edge(5, {5, 7, 2});
-        g.add_edge(6, {6, 9, 1});
-        g.add_edge(7, {7, 8, 1});
-        g.add_edge(7, {7, 10, 1});
-        g.add_edge(8, {8, 6, 3});
-        g.add_edge(9, {9, 8, -6});
-        g.add_edge(10, {10, 10, -1});
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, -6},
+                {10, 10, -1},
+        });
         const bellman_ford_result result = bellman_ford(g, 1);
         display_all_shortest_paths(result);
     }
+    std::cout << "Example 6" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        const csr_graph g(12, {
+                {0, 1, 1},
+                {1, 2, 8},
+                {1, 3, 4},
+                {1, 4, 1},
+                {2, 5, 2},
+                {3, 5, 2},
+                {4, 3, 2},
+                {4, 4, 3},
+                {4, 6, 6},
+                {5, 2, 1},
+                {5, 6, 1},
+                {5, 7, 2},
+                {6, 9, 1},
+                {7, 8, 1},
+                {7, 10, 1},
+                {8, 6, 3},
+                {9, 8, -6},
+                {10, 10, -1},
+        });
+        const bellman_ford_result result = bellman_ford_queue(g, 1);
+        display_all_shortest_paths(result);
+    }
     return 0;
 }
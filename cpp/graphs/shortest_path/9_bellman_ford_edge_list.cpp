@@ -1,8 +1,23 @@
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "../edge_list_parser.h"
+#include "../temporary_file.h"
+#include "../thread_pool.h"
+
 constexpr double POSITIVE_INFINITY = std::numeric_limits<double>::infinity();
 constexpr double NEGATIVE_INFINITY = -POSITIVE_INFINITY;
 
@@ -12,6 +27,9 @@ struct edge {
     const double cost;
 };
 
+// Number of edges handled by one step of the widest kernel of 'bellman_ford_simd' (8 doubles per AVX-512 register).
+constexpr int SIMD_LANES = 8;
+
 struct bellman_ford_result {
     const int src_vertex;
     const std::vector<double> dist;
@@ -62,6 +80,270 @@ bellman_ford_result bellman_ford(const std::vector<edge> &edges, int vertices, i
     return bellman_ford_result{src_vertex, dist, parent};
 }
 
+// Lock-free 'dist = min(dist, value)'. Returns whether 'dist' was lowered.
+bool atomic_min(std::atomic<double> &dist, double value) {
+    double current = dist.load(std::memory_order_relaxed);
+    while (value < current) {
+        if (dist.compare_exchange_weak(current, value, std::memory_order_relaxed)) { return true; }
+    }
+    return false;
+}
+
+// Parallel Bellman-Ford. Every round is split among the threads of 'pool', each one relaxing its own slice of
+// 'edges' with an atomic min on the distances, since several threads may lower the same vertex at once. A
+// thread sets the shared 'some_edge_relaxed' flag at most once per round, which keeps the early termination
+// without contention. Rounds may see the updates of other threads earlier or later, but they never converge
+// slower than the sequential rounds, so the distances (and the NEGATIVE_INFINITY marks) are the same as the
+// ones of 'bellman_ford' for any number of threads.
+bellman_ford_result bellman_ford_parallel(const std::vector<edge> &edges, int vertices, int src_vertex,
+                                          thread_pool &pool) {
+    std::vector<std::atomic<double>> dist(vertices);
+    for (auto &d: dist) { d.store(POSITIVE_INFINITY, std::memory_order_relaxed); }
+    dist[src_vertex].store(0, std::memory_order_relaxed);
+    const long long edge_count = static_cast<long long>(edges.size());
+    const int threads = pool.size();
+    std::atomic<bool> some_edge_relaxed(true);
+    // Same two phases as 'bellman_ford': shortest distances first, then propagation of NEGATIVE_INFINITY. A
+    // round only carries the marks one edge further when threads miss each other's writes, and the first one
+    // may mark a single vertex of a cycle, so the second phase can take V rounds instead of V-1.
+    for (const bool negative_cycles: {false, true}) {
+        const int rounds = negative_cycles ? vertices : vertices - 1;
+        for (int _ = 0; _ < rounds && some_edge_relaxed.load(); ++_) {
+            some_edge_relaxed.store(false);
+            pool.run([&](int thread_id) {
+                const long long first = edge_count * thread_id / threads;
+                const long long last = edge_count * (thread_id + 1) / threads;
+                bool relaxed = false;
+                for (long long i = first; i < last; ++i) {
+                    const edge &e = edges[i];
+                    const double new_distance = dist[e.from].load(std::memory_order_relaxed) + e.cost;
+                    if (negative_cycles) {
+                        if (new_distance < dist[e.to].load(std::memory_order_relaxed)) {
+                            dist[e.to].store(NEGATIVE_INFINITY, std::memory_order_relaxed);
+                            relaxed = true;
+                        }
+                    } else {
+                        relaxed = atomic_min(dist[e.to], new_distance) || relaxed;
+                    }
+                }
+                if (relaxed) { some_edge_relaxed.store(true, std::memory_order_relaxed); }
+            });
+        }
+    }
+
+    std::vector<double> result_dist(vertices);
+    for (int i = 0; i < vertices; ++i) { result_dist[i] = dist[i].load(std::memory_order_relaxed); }
+    // The parents are chosen once the distances are final, with a BFS from 'src_vertex' over the edges with
+    // dist[from] + cost == dist[to]. Taking any such edge as the parent of 'to' could close a cycle of
+    // parents along a cycle of zero cost. The edges are grouped by 'from' with a counting sort first.
+    const auto tight = [&](const edge &e) {
+        return std::isfinite(result_dist[e.from]) && result_dist[e.from] + e.cost == result_dist[e.to];
+    };
+    std::vector<int> offsets(vertices + 1, 0);
+    for (const auto &e: edges) {
+        if (tight(e)) { ++offsets[e.from + 1]; }
+    }
+    for (int v = 0; v < vertices; ++v) { offsets[v + 1] += offsets[v]; }
+    std::vector<int> tight_to(offsets.back());
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (const auto &e: edges) {
+        if (tight(e)) { tight_to[next[e.from]++] = e.to; }
+    }
+    std::vector<int> parent(vertices, -1);
+    std::vector<bool> visited(vertices, false);
+    std::queue<int> q;
+    if (std::isfinite(result_dist[src_vertex])) {
+        visited[src_vertex] = true;
+        q.push(src_vertex);
+    }
+    while (!q.empty()) {
+        const int vertex = q.front(); q.pop();
+        for (int i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            if (!visited[tight_to[i]]) {
+                visited[tight_to[i]] = true;
+                parent[tight_to[i]] = vertex;
+                q.push(tight_to[i]);
+            }
+        }
+    }
+
+    return bellman_ford_result{src_vertex, std::move(result_dist), std::move(parent)};
+}
+
+// Edge list in 'structure of arrays' layout: the i-th edge is (from[i], to[i], cost[i]). Unlike an array of
+// 'edge' records, each field is contiguous, so a SIMD kernel loads the fields of several edges with a single
+// instruction each. The arrays are padded to a multiple of SIMD_LANES with edges 0 -> 0 of infinite cost,
+// which can never be relaxed.
+// With 'sort_by_to', the edges are sorted by 'to' and dealt to the lanes in SIMD_LANES contiguous sections:
+// lane k of every step walks through section k. The writes to dist[to] of a lane then move forward through
+// memory, and two lanes of the same step can only write the same vertex if it has more incoming edges than
+// the length of a section, so conflicts (which force the slow path of the kernels) become very rare.
+struct soa_edge_list {
+    std::vector<int> from, to;
+    std::vector<double> cost;
+
+    explicit soa_edge_list(const std::vector<edge> &edges, bool sort_by_to = false) {
+        const std::size_t steps = (edges.size() + SIMD_LANES - 1) / SIMD_LANES;
+        from.assign(steps * SIMD_LANES, 0);
+        to.assign(steps * SIMD_LANES, 0);
+        cost.assign(steps * SIMD_LANES, POSITIVE_INFINITY);
+        std::vector<std::size_t> order(edges.size());
+        for (std::size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+        if (sort_by_to) {
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return edges[a].to < edges[b].to;
+            });
+        }
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            // Position of the i-th edge: either i itself, or row i % steps of lane i / steps.
+            const std::size_t position = sort_by_to ? i % steps * SIMD_LANES + i / steps : i;
+            from[position] = edges[order[i]].from;
+            to[position] = edges[order[i]].to;
+            cost[position] = edges[order[i]].cost;
+        }
+    }
+    std::size_t size() const { return from.size(); }
+};
+
+enum class simd_level { scalar, avx2, avx512 };
+
+// Widest kernel of 'bellman_ford_simd' supported by the CPU running the program.
+simd_level detect_simd_level() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd")) { return simd_level::avx512; }
+    if (__builtin_cpu_supports("avx2")) { return simd_level::avx2; }
+#endif
+    return simd_level::scalar;
+}
+
+// One round over all the edges. In the second phase ('negative_cycles'), a relaxable edge marks its 'to'
+// vertex with NEGATIVE_INFINITY instead of lowering it. Returns whether some edge was relaxed.
+bool relax_edges_scalar(const soa_edge_list &edges, double *dist, int *parent, bool negative_cycles) {
+    bool relaxed = false;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const double new_distance = dist[edges.from[i]] + edges.cost[i];
+        if (new_distance < dist[edges.to[i]]) {
+            dist[edges.to[i]] = negative_cycles ? NEGATIVE_INFINITY : new_distance;
+            parent[edges.to[i]] = negative_cycles ? -1 : edges.from[i];
+            relaxed = true;
+        }
+    }
+    return relaxed;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The lanes of a step whose edge can be relaxed are written one at a time, checking again the distance of
+// 'to', since two of them may point to the same vertex.
+inline bool relax_lanes(const soa_edge_list &edges, std::size_t i, const double *new_distance, int lanes,
+                        double *dist, int *parent, bool negative_cycles) {
+    bool relaxed = false;
+    for (; lanes != 0; lanes &= lanes - 1) {
+        const int k = __builtin_ctz(lanes);
+        if (new_distance[k] < dist[edges.to[i + k]]) {
+            dist[edges.to[i + k]] = negative_cycles ? NEGATIVE_INFINITY : new_distance[k];
+            parent[edges.to[i + k]] = negative_cycles ? -1 : edges.from[i + k];
+            relaxed = true;
+        }
+    }
+    return relaxed;
+}
+
+// AVX2 kernel, 4 edges per step: dist[from] and dist[to] are gathered, and since AVX2 has no scatter, the
+// (usually few) lanes that improve their vertex are written with scalar stores.
+__attribute__((target("avx2")))
+bool relax_edges_avx2(const soa_edge_list &edges, double *dist, int *parent, bool negative_cycles) {
+    bool relaxed = false;
+    alignas(32) double new_distance[4];
+    // The masked gathers, with every lane enabled, are the same as the plain ones.
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (std::size_t i = 0; i < edges.size(); i += 4) {
+        const __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i *>(edges.from.data() + i));
+        const __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i *>(edges.to.data() + i));
+        const __m256d candidate = _mm256_add_pd(_mm256_mask_i32gather_pd(zero, dist, from, all_lanes, 8),
+                                                _mm256_loadu_pd(edges.cost.data() + i));
+        const __m256d current = _mm256_mask_i32gather_pd(zero, dist, to, all_lanes, 8);
+        const int lanes = _mm256_movemask_pd(_mm256_cmp_pd(candidate, current, _CMP_LT_OQ));
+        if (lanes == 0) { continue; }
+        _mm256_store_pd(new_distance, candidate);
+        relaxed = relax_lanes(edges, i, new_distance, lanes, dist, parent, negative_cycles) || relaxed;
+    }
+    return relaxed;
+}
+
+// AVX-512 kernel, 8 edges per step. The improving lanes are written with a masked scatter, unless two of them
+// point to the same vertex ('_mm512_conflict_epi32' gives, for every lane, the earlier lanes holding the
+// same value), in which case the step falls back to the scalar writes of the AVX2 kernel.
+__attribute__((target("avx512f,avx512cd")))
+bool relax_edges_avx512(const soa_edge_list &edges, double *dist, int *parent, bool negative_cycles) {
+    bool relaxed = false;
+    alignas(64) double new_distance[8];
+    const __m512d marked_dist = _mm512_set1_pd(NEGATIVE_INFINITY);
+    const __m512i marked_parent = _mm512_set1_epi32(-1);
+    const __m512d zero = _mm512_setzero_pd();
+    for (std::size_t i = 0; i < edges.size(); i += 8) {
+        const __m256i from = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges.from.data() + i));
+        const __m256i to = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges.to.data() + i));
+        const __m512d candidate = _mm512_add_pd(_mm512_mask_i32gather_pd(zero, 0xff, from, dist, 8),
+                                                _mm512_loadu_pd(edges.cost.data() + i));
+        const __m512d current = _mm512_mask_i32gather_pd(zero, 0xff, to, dist, 8);
+        const __mmask8 lanes = _mm512_cmp_pd_mask(candidate, current, _CMP_LT_OQ);
+        if (lanes == 0) { continue; }
+        relaxed = true;
+        // The conflict detection and the scatter of 'parent' work on 16 lanes of 32 bits, so the indices are
+        // loaded again into the lower half of such a register, with zeros in the upper half (those lanes are
+        // never compared with the lower ones).
+        const __m512i from_wide = _mm512_maskz_loadu_epi32(0xff, edges.from.data() + i);
+        const __m512i to_wide = _mm512_maskz_loadu_epi32(0xff, edges.to.data() + i);
+        const __m512i conflicts = _mm512_conflict_epi32(to_wide);
+        if (_mm512_mask_test_epi32_mask(lanes, conflicts, _mm512_set1_epi32(lanes)) == 0) {
+            _mm512_mask_i32scatter_pd(dist, lanes, to, negative_cycles ? marked_dist : candidate, 8);
+            _mm512_mask_i32scatter_epi32(parent, lanes, to_wide, negative_cycles ? marked_parent : from_wide, 4);
+        } else {
+            _mm512_store_pd(new_distance, candidate);
+            relax_lanes(edges, i, new_distance, lanes, dist, parent, negative_cycles);
+        }
+    }
+    return relaxed;
+}
+#endif
+
+// Bellman-Ford on a 'soa_edge_list' with SIMD relaxation kernels, chosen at runtime by 'level' (by default
+// the widest one the CPU supports, falling back to scalar code). Within a step, the lanes read the distances
+// before any of them is written, so a round may make a bit less progress than a sequential one, but never
+// less than a round over a copy of the distances, and a round without relaxations still means that all of
+// them are final. Thus the result is the same as the one of 'bellman_ford' (parents may differ among the
+// equally short alternatives).
+bellman_ford_result bellman_ford_simd(const soa_edge_list &edges, int vertices, int src_vertex,
+                                      simd_level level = detect_simd_level()) {
+    std::vector<double> dist(vertices, POSITIVE_INFINITY);
+    dist[src_vertex] = 0;
+    std::vector<int> parent(vertices, -1);
+    const auto relax_edges = [&](bool negative_cycles) {
+#if defined(__x86_64__) || defined(__i386__)
+        if (level == simd_level::avx512) {
+            return relax_edges_avx512(edges, dist.data(), parent.data(), negative_cycles);
+        }
+        if (level == simd_level::avx2) {
+            return relax_edges_avx2(edges, dist.data(), parent.data(), negative_cycles);
+        }
+#endif
+        return relax_edges_scalar(edges, dist.data(), parent.data(), negative_cycles);
+    };
+
+    // Same two phases as 'bellman_ford', where the second one can take V rounds for the same reason as in
+    // 'bellman_ford_parallel'.
+    bool some_edge_relaxed = true;
+    for (int _ = 0; _ < vertices - 1 && some_edge_relaxed; ++_) {
+        some_edge_relaxed = relax_edges(false);
+    }
+    for (int _ = 0; _ < vertices && some_edge_relaxed; ++_) {
+        some_edge_relaxed = relax_edges(true);
+    }
+
+    return bellman_ford_result{src_vertex, std::move(dist), std::move(parent)};
+}
+
 void display_shortest_path(const bellman_ford_result &result, int dest_vertex) {
     std::cout << "From " << result.src_vertex << " to " << dest_vertex << ": ["
               << std::setw(4) << result.dist[dest_vertex] << "] ";
@@ -188,5 +470,114 @@ int main() {
         const bellman_ford_result result = bellman_ford(edges, 12, 1);
         display_all_shortest_paths(result);
     }
+    std::cout << "Example 6" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        const std::vector<edge> edges = {
+                {0,  1,  1},
+                {1,  2,  8},
+                {1,  3,  4},
+                {1,  4,  1},
+                {2,  5,  2},
+                {3,  5,  2},
+                {4,  3,  2},
+                {4,  4,  3},
+                {4,  6,  6},
+                {5,  2,  1},
+                {5,  6,  1},
+                {5,  7,  2},
+                {6,  9,  1},
+                {7,  8,  1},
+                {7,  10, 1},
+                {8,  6,  3},
+                {9,  8,  -6},
+                {10, 10, -1},
+        };
+        thread_pool pool(4);
+        const bellman_ford_result result = bellman_ford_parallel(edges, 12, 1, pool);
+        display_all_shortest_paths(result);
+    }
+    std::cout << "Example 7" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        const std::vector<edge> edges = {
+                {0,  1,  1},
+                {1,  2,  8},
+                {1,  3,  4},
+                {1,  4,  1},
+                {2,  5,  2},
+                {3,  5,  2},
+                {4,  3,  2},
+                {4,  4,  3},
+                {4,  6,  6},
+                {5,  2,  1},
+                {5,  6,  1},
+                {5,  7,  2},
+                {6,  9,  1},
+                {7,  8,  1},
+                {7,  10, 1},
+                {8,  6,  3},
+                {9,  8,  -6},
+                {10, 10, -1},
+        };
+        const bellman_ford_result result = bellman_ford_simd(soa_edge_list(edges, true), 12, 1);
+        display_all_shortest_paths(result);
+        // Every kernel up to the widest one of this CPU, on this graph and on a random one with many edges into
+        // few vertices (so lanes of the same step often write the same vertex), with and without sorting.
+        std::mt19937 rng(1);
+        std::vector<edge> random_edges;
+        for (int i = 0; i < 5000; ++i) {
+            random_edges.push_back({static_cast<int>(rng() % 200), static_cast<int>(rng() % 20),
+                                    static_cast<double>(rng() % 21)});
+            random_edges.push_back({static_cast<int>(rng() % 20), static_cast<int>(rng() % 200),
+                                    static_cast<double>(rng() % 21)});
+        }
+        const std::vector<double> expected = bellman_ford(edges, 12, 1).dist;
+        const std::vector<double> random_expected = bellman_ford(random_edges, 200, 0).dist;
+        const char *names[] = {"scalar", "avx2", "avx512"};
+        for (int level = 0; level <= static_cast<int>(detect_simd_level()); ++level) {
+            bool same = true;
+            for (const bool sort_by_to: {false, true}) {
+                const simd_level l = static_cast<simd_level>(level);
+                same = same && bellman_ford_simd(soa_edge_list(edges, sort_by_to), 12, 1, l).dist == expected
+                       && bellman_ford_simd(soa_edge_list(random_edges, sort_by_to), 200, 0, l).dist == random_expected;
+            }
+            std::cout << "Same distances as bellman_ford with the " << names[level] << " kernel: "
+                      << (same ? "yes" : "no") << std::endl;
+        }
+    }
+    std::cout << "Example 8" << std::endl;  // resources/digraph_weighted_neg_cycles.svg
+    {
+        // The same graph as a DIMACS file, where the vertices are numbered from 1.
+        const temporary_file file(".gr");
+        {
+            std::ofstream out(file.path());
+            out << "c resources/digraph_weighted_neg_cycles.svg\n"
+                   "p sp 12 18\n"
+                   "a 1 2 1\na 2 3 8\na 2 4 4\na 2 5 1\na 3 6 2\na 4 6 2\na 5 4 2\na 5 5 3\na 5 7 6\n"
+                   "a 6 3 1\na 6 7 1\na 6 8 2\na 7 10 1\na 8 9 1\na 8 11 1\na 9 7 3\na 10 9 -6\na 11 11 -1\n";
+        }
+        thread_pool pool(2);
+        const parsed_edge_list<edge> g = parse_edge_list<edge>(file.path(), edge_list_format::dimacs, pool);
+        const bellman_ford_result result = bellman_ford(g.edges, g.vertices, 1);
+        display_all_shortest_paths(result);
+        // The file above is too small to be split among the threads, so a SNAP file of a few megabytes checks
+        // that the split at line boundaries and the concatenation of the parts give the edges in file order.
+        const temporary_file large_file(".txt");
+        {
+            std::ofstream out(large_file.path());
+            out << "# random weighted digraph\n";
+            for (long long i = 0; i < 300000; ++i) {
+                out << (i * 7919) % 100000 << ' ' << (i * 104729) % 100000 << ' ' << i % 97 << '\n';
+            }
+        }
+        const parsed_edge_list<edge> single = parse_edge_list<edge>(large_file.path(), edge_list_format::snap);
+        const parsed_edge_list<edge> split = parse_edge_list<edge>(large_file.path(), edge_list_format::snap, pool);
+        bool same = single.vertices == split.vertices && single.edges.size() == split.edges.size();
+        for (std::size_t i = 0; same && i < single.edges.size(); ++i) {
+            same = single.edges[i].from == split.edges[i].from && single.edges[i].to == split.edges[i].to
+                   && single.edges[i].cost == split.edges[i].cost;
+        }
+        std::cout << "Same " << single.edges.size() << " edges parsed by 1 and " << pool.size() << " threads: "
+                  << (same ? "yes" : "no") << std::endl;
+    }
     return 0;
 }
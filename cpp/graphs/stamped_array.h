@@ -0,0 +1,40 @@
+#ifndef ALGORITHMS_GRAPHS_STAMPED_ARRAY_H
+#define ALGORITHMS_GRAPHS_STAMPED_ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Array of per-vertex values that can be reset to a default value in O(1). Every entry carries the
+// generation in which it was last written, and an entry whose stamp differs from the current generation
+// reads as the default value, so 'reset' only has to bump the generation. A search that reuses the same
+// array for many queries therefore pays for the entries it touches instead of an O(V) initialization. The
+// stamps are only cleared for real once every 2^32 resets, when the generation counter wraps around.
+template<typename T>
+class stamped_array {
+private:
+    std::vector<T> values;
+    std::vector<std::uint32_t> stamps;
+    std::uint32_t generation = 1;
+    T default_value;
+public:
+    stamped_array(int size, const T &default_value)
+            : values(size, default_value), stamps(size, 0), default_value(default_value) {}
+    std::size_t size() const { return values.size(); }
+    T operator[](int i) const { return stamps[i] == generation ? values[i] : default_value; }
+    // Whether entry i was written since the last reset.
+    bool touched(int i) const { return stamps[i] == generation; }
+    void set(int i, const T &value) {
+        values[i] = value;
+        stamps[i] = generation;
+    }
+    void reset() {
+        if (++generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+};
+
+#endif  // ALGORITHMS_GRAPHS_STAMPED_ARRAY_H
@@ -0,0 +1,37 @@
+#ifndef ALGORITHMS_GRAPHS_TEMPORARY_FILE_H
+#define ALGORITHMS_GRAPHS_TEMPORARY_FILE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Empty file with a unique name in the temporary directory ($TMPDIR, or /tmp), removed when the object goes out
+// of scope, also when an exception is thrown. The examples that read graphs from files write them here, so they
+// run in a read-only working directory and several runs don't overwrite each other's files.
+class temporary_file {
+private:
+    std::string file_path;
+public:
+    // 'suffix' is appended to the name, e.g. an extension.
+    explicit temporary_file(const std::string &suffix = "") {
+        const char *directory = std::getenv("TMPDIR");
+        std::string pattern = std::string(directory != nullptr && *directory != '\0' ? directory : "/tmp")
+                              + "/graph-XXXXXX" + suffix;
+        std::vector<char> name(pattern.begin(), pattern.end());
+        name.push_back('\0');
+        const int fd = mkstemps(name.data(), static_cast<int>(suffix.size()));
+        if (fd == -1) { throw std::runtime_error("temporary_file: can't create " + pattern); }
+        close(fd);
+        file_path = name.data();
+    }
+    temporary_file(const temporary_file &) = delete;
+    temporary_file &operator=(const temporary_file &) = delete;
+    ~temporary_file() { std::remove(file_path.c_str()); }
+    const std::string &path() const { return file_path; }
+};
+
+#endif  // ALGORITHMS_GRAPHS_TEMPORARY_FILE_H
@@ -0,0 +1,83 @@
+#ifndef ALGORITHMS_GRAPHS_THREAD_POOL_H
+#define ALGORITHMS_GRAPHS_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join parallelism. The threads are created once and reused by every
+// 'run', so a parallel algorithm can synchronize many times (e.g. once per BFS level) without paying for
+// thread creation each time. The calling thread takes part in the work as the thread with id 0.
+class thread_pool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)> *task = nullptr;
+    unsigned long long generation = 0;
+    int running = 0;
+    bool stopping = false;
+
+    void work(int thread_id) {
+        unsigned long long seen_generation = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) { return; }
+            seen_generation = generation;
+            const std::function<void(int)> &current_task = *task;
+            lock.unlock();
+            current_task(thread_id);
+            lock.lock();
+            if (--running == 0) { done.notify_one(); }
+        }
+    }
+public:
+    explicit thread_pool(int threads = static_cast<int>(std::thread::hardware_concurrency())) {
+        for (int thread_id = 1; thread_id < std::max(threads, 1); ++thread_id) {
+            workers.emplace_back(&thread_pool::work, this, thread_id);
+        }
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker: workers) { worker.join(); }
+    }
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+    // Calls 'f(thread_id)' once on every thread of the pool and waits until all of them have returned.
+    void run(const std::function<void(int)> &f) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &f;
+            running = static_cast<int>(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+        f(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return running == 0; });
+    }
+    // Calls 'body(thread_id, i)' for every i in [begin, end). Threads grab 'chunk' consecutive indices at a
+    // time, so the load stays balanced even when some iterations are much more expensive than others.
+    template<typename Body>
+    void parallel_for(long long begin, long long end, long long chunk, const Body &body) {
+        std::atomic<long long> next(begin);
+        run([&](int thread_id) {
+            for (long long first = next.fetch_add(chunk); first < end; first = next.fetch_add(chunk)) {
+                const long long last = std::min(first + chunk, end);
+                for (long long i = first; i < last; ++i) { body(thread_id, i); }
+            }
+        });
+    }
+};
+
+#endif  // ALGORITHMS_GRAPHS_THREAD_POOL_H
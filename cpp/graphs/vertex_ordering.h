@@ -0,0 +1,224 @@
+#ifndef ALGORITHMS_GRAPHS_VERTEX_ORDERING_H
+#define ALGORITHMS_GRAPHS_VERTEX_ORDERING_H
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+
+// Relabeling of the vertices of a graph. Searches read and write per-vertex arrays (e.g. 'dist[edge.to]') at the
+// labels of the neighbors of the current vertex, so with arbitrary labels almost every access lands on a different
+// cache line. An ordering that gives close labels to adjacent vertices turns those accesses into nearby ones, and
+// also makes the search visit the adjacency lists in roughly sequential order.
+struct vertex_permutation {
+    // new_id[v] is the label of the original vertex v in the reordered graph.
+    const std::vector<int> new_id;
+    // old_id[i] is the original vertex labeled i, the inverse of 'new_id'.
+    const std::vector<int> old_id;
+};
+
+// Builds the permutation that labels 'order[i]' as i. 'order' must list every vertex exactly once.
+inline vertex_permutation make_permutation(std::vector<int> order) {
+    std::vector<int> new_id(order.size(), -1);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        assert(0 <= order[i] && order[i] < static_cast<int>(order.size()) && new_id[order[i]] == -1);
+        new_id[order[i]] = static_cast<int>(i);
+    }
+    return {std::move(new_id), std::move(order)};
+}
+
+// The orderings below ignore the direction of the edges: the neighbors of a vertex are the targets of its
+// outgoing edges followed by the sources of its incoming ones, taken from 'reversed'.
+inline std::vector<int> undirected_degrees(const csr_graph &graph, const csr_graph &reversed) {
+    std::vector<int> degree(graph.size());
+    for (int v = 0; v < static_cast<int>(graph.size()); ++v) {
+        degree[v] = graph.degree(v) + reversed.degree(v);
+    }
+    return degree;
+}
+
+// Vertices by decreasing degree (in plus out), ties broken by their original label. The few high degree vertices
+// that most edges point to end up packed in the first cache lines, which then stay cached.
+inline vertex_permutation degree_order(const csr_graph &graph) {
+    const std::vector<int> degree = undirected_degrees(graph, graph.reversed());
+    std::vector<int> order(graph.size());
+    for (std::size_t v = 0; v < order.size(); ++v) { order[v] = static_cast<int>(v); }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree[a] > degree[b]; });
+    return make_permutation(std::move(order));
+}
+
+// Vertices in the order a BFS from 'src_vertex' discovers them, followed by those of the other connected
+// components, each one explored from its smallest label. Adjacent vertices are in the same or consecutive
+// levels, so they get close labels.
+inline vertex_permutation bfs_order(const csr_graph &graph, int src_vertex = 0) {
+    const int vertices = static_cast<int>(graph.size());
+    const csr_graph reversed = graph.reversed();
+    std::vector<int> order;
+    order.reserve(vertices);
+    std::vector<bool> visited(vertices, false);
+    const auto visit = [&](int v) {
+        if (!visited[v]) {
+            visited[v] = true;
+            order.push_back(v);
+        }
+    };
+    for (int i = -1; i < vertices; ++i) {
+        const int root = i == -1 ? src_vertex : i;
+        if (visited[root]) { continue; }
+        std::size_t head = order.size();
+        visit(root);
+        for (; head < order.size(); ++head) {
+            for (const auto edge: graph.adj_list(order[head])) { visit(edge.to); }
+            for (const auto edge: reversed.adj_list(order[head])) { visit(edge.to); }
+        }
+    }
+    return make_permutation(std::move(order));
+}
+
+// Reverse Cuthill-McKee: a BFS that enqueues the unvisited neighbors of every vertex by increasing degree, started
+// in each connected component from a pseudo-peripheral vertex, whose order is finally reversed. It keeps the
+// labels of adjacent vertices within a narrow band (small bandwidth), which is what the cache needs. The
+// pseudo-peripheral vertex is found as in George & Liu (1979): starting from a vertex of minimum degree, jump to
+// a vertex of minimum degree in the last BFS level while that increases the eccentricity.
+inline vertex_permutation reverse_cuthill_mckee(const csr_graph &graph) {
+    const int vertices = static_cast<int>(graph.size());
+    const csr_graph reversed = graph.reversed();
+    const std::vector<int> degree = undirected_degrees(graph, reversed);
+    const auto neighbors = [&](int v, std::vector<int> &out) {
+        out.clear();
+        for (const auto edge: graph.adj_list(v)) { out.push_back(edge.to); }
+        for (const auto edge: reversed.adj_list(v)) { out.push_back(edge.to); }
+    };
+
+    // The first unvisited vertex in this order has the minimum degree of its component.
+    std::vector<int> by_degree(vertices);
+    for (int v = 0; v < vertices; ++v) { by_degree[v] = v; }
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b) { return degree[a] < degree[b]; });
+
+    std::vector<int> order, level(vertices, -1), adjacent, component;
+    order.reserve(vertices);
+    std::vector<bool> visited(vertices, false);
+    // BFS over the unvisited vertices from 'root', leaving them in 'component' with their level set. Returns
+    // the eccentricity of 'root'.
+    const auto levels = [&](int root) {
+        for (const int v: component) { level[v] = -1; }
+        component.assign(1, root);
+        level[root] = 0;
+        for (std::size_t head = 0; head < component.size(); ++head) {
+            neighbors(component[head], adjacent);
+            for (const int u: adjacent) {
+                if (!visited[u] && level[u] == -1) {
+                    level[u] = level[component[head]] + 1;
+                    component.push_back(u);
+                }
+            }
+        }
+        return level[component.back()];
+    };
+    for (const int start: by_degree) {
+        if (visited[start]) { continue; }
+        int root = start, eccentricity = levels(root);
+        while (true) {
+            // Vertex of minimum degree in the last level, which is at the end of 'component'.
+            int candidate = component.back();
+            for (auto it = component.rbegin(); it != component.rend() && level[*it] == eccentricity; ++it) {
+                if (degree[*it] < degree[candidate]) { candidate = *it; }
+            }
+            const int candidate_eccentricity = levels(candidate);
+            if (candidate_eccentricity <= eccentricity) { break; }
+            root = candidate;
+            eccentricity = candidate_eccentricity;
+        }
+        for (const int v: component) { level[v] = -1; }
+        component.clear();
+
+        // Cuthill-McKee from 'root'.
+        std::size_t head = order.size();
+        visited[root] = true;
+        order.push_back(root);
+        for (; head < order.size(); ++head) {
+            neighbors(order[head], adjacent);
+            const std::size_t first = order.size();
+            for (const int u: adjacent) {
+                if (!visited[u]) {
+                    visited[u] = true;
+                    order.push_back(u);
+                }
+            }
+            std::stable_sort(order.begin() + first, order.end(), [&](int a, int b) { return degree[a] < degree[b]; });
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return make_permutation(std::move(order));
+}
+
+// Graph relabeled by a permutation, together with the permutation, so that queries can be answered in terms
+// of the original labels.
+struct reordered_graph {
+    const csr_graph graph;
+    const vertex_permutation permutation;
+};
+
+// Builds the graph with every vertex v labeled 'permutation.new_id[v]' in O(V+E log(max degree)). The adjacency
+// list of every vertex is sorted by target, so that scanning it also walks the per-vertex arrays forwards.
+inline reordered_graph reorder(const csr_graph &graph, vertex_permutation permutation) {
+    assert(permutation.new_id.size() == graph.size());
+    std::vector<edge> edges;
+    edges.reserve(graph.edge_count());
+    std::vector<std::pair<int, double>> arcs;
+    for (std::size_t i = 0; i < graph.size(); ++i) {
+        const int old_vertex = permutation.old_id[i];
+        arcs.clear();
+        for (const auto edge: graph.adj_list(old_vertex)) { arcs.emplace_back(permutation.new_id[edge.to], edge.cost); }
+        std::stable_sort(arcs.begin(), arcs.end(),
+                         [](const std::pair<int, double> &a, const std::pair<int, double> &b) {
+                             return a.first < b.first;
+                         });
+        for (const auto &arc: arcs) { edges.push_back({static_cast<int>(i), arc.first, arc.second}); }
+    }
+    return {csr_graph(static_cast<int>(graph.size()), edges), std::move(permutation)};
+}
+
+// Per-vertex values computed on the reordered graph (indexed by new label), indexed by original vertex.
+template<typename T>
+std::vector<T> to_original_order(const std::vector<T> &values, const vertex_permutation &permutation) {
+    std::vector<T> result;
+    result.reserve(values.size());
+    for (const int i: permutation.new_id) { result.push_back(values[i]); }
+    return result;
+}
+
+// Per-vertex vertex labels computed on the reordered graph (e.g. a parent array), indexed by original vertex and
+// translated to original vertices. Negative values (no vertex) are kept.
+inline std::vector<int> to_original_vertices(const std::vector<int> &vertices, const vertex_permutation &permutation) {
+    std::vector<int> result;
+    result.reserve(vertices.size());
+    for (const int i: permutation.new_id) {
+        result.push_back(vertices[i] < 0 ? vertices[i] : permutation.old_id[vertices[i]]);
+    }
+    return result;
+}
+
+// Bandwidth and average label gap |new_id[u] - new_id[v]| over the edges u -> v: how far apart the per-vertex
+// entries read while scanning an adjacency list are. Useful as a proxy of the cache misses of a search.
+struct ordering_quality {
+    const int bandwidth;
+    const double average_gap;
+};
+
+inline ordering_quality measure_ordering(const csr_graph &graph) {
+    int bandwidth = 0;
+    double total_gap = 0;
+    for (int v = 0; v < static_cast<int>(graph.size()); ++v) {
+        for (const auto edge: graph.adj_list(v)) {
+            const int gap = edge.to > v ? edge.to - v : v - edge.to;
+            bandwidth = std::max(bandwidth, gap);
+            total_gap += gap;
+        }
+    }
+    return {bandwidth, graph.edge_count() == 0 ? 0.0 : total_gap / static_cast<double>(graph.edge_count())};
+}
+
+#endif  // ALGORITHMS_GRAPHS_VERTEX_ORDERING_H